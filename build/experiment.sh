@@ -15,6 +15,10 @@ if [ "$1" == "exp1" ]; then
             ./sim_cache 32 $L1size $L1Assoc 0 0 0 0 /home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/traces/gcc_trace.txt
         done
     done
+# experiment one, every point from a single pass over the trace
+elif [ "$1" == "exp1-sweep" ]; then
+    mkdir -p exp1
+    ./sim_cache sweep 32 1024 1048576 /home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/traces/gcc_trace.txt > exp1/lru_sweep.txt
 # experiment two
 elif [ "$1" == "exp2" ]; then
     for (( outer=10; outer<=18; outer++ )); do
@@ -36,4 +40,17 @@ elif [ "$1" == "exp3" ]; then
         # inclusive   
         ./sim_cache 32 1024 4 $L2size 8 0 1 /home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/traces/gcc_trace.txt
     done
+# experiment 3, simulating L1 once and replaying its requests into each L2
+elif [ "$1" == "exp3-replay" ]; then
+    ./sim_cache 32 1024 4 0 0 0 0 /home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/traces/gcc_trace.txt --record-l1 l1_requests.bin > /dev/null
+    for (( outer=11; outer<=16; outer++ )); do
+        L2size=$((2**outer))
+        # non-inclusive
+        ./sim_cache 32 0 0 $L2size 8 0 0 l1_requests.bin
+    done
+# experiments two and three, each as one parallel grid over a single parse of the trace
+elif [ "$1" == "grid" ]; then
+    mkdir -p exp2 exp3
+    ./sim_cache grid 32 1024,2048,4096,8192,16384,32768,65536,131072,262144 4 0 0 0,1,2 0 /home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/traces/gcc_trace.txt > exp2/grid.csv
+    ./sim_cache grid 32 1024 4 2048,4096,8192,16384,32768,65536 8 0 0,1 /home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/traces/gcc_trace.txt > exp3/grid.csv
 fi
\ No newline at end of file
@@ -2,11 +2,20 @@ import numpy as np
 import matplotlib.pyplot as plt
 import matplotlib.cm as cm
 import pandas as pd
+import os
 
 df = pd.read_excel("/home/razgriz117/Martin/CodeDirectory/UCF/architecture/program1/assignment/cacti_table.xls")
 
 do_aat = False
 exp = 1
+# `sim_cache sweep 32 1024 1048576 <trace> > exp1/lru_sweep.txt` computes every exp1 point in
+# one pass; its rates are used in place of the per-run files when present.
+exp1_table = "exp1/lru_sweep.txt"
+exp1_rates = {}
+if exp == 1 and os.path.exists(exp1_table):
+    table = pd.read_csv(exp1_table, sep=" ")
+    exp1_rates = {(int(row["size"]), int(row["assoc"])): row["miss_rate"]
+                  for _, row in table.iterrows()}
 # get values
 values = []
 if exp == 1:
@@ -19,27 +28,29 @@ if exp == 1:
                 sizewise.append(np.nan)
                 continue
             filename = "exp1/ASSOC_"+str(L1assoc)+"_L1Size_"+str(L1size)+".txt"
-            with open(filename, "r") as file:
-                L1MR = float(file.readlines()[0])
-                if do_aat:
-                    # calculate AAT = L1 hit time + L1 MR . Miss penalty(100 ns)
-                    if L1assoc == int(L1size/32): assoc = "FA"
-                    else: assoc = L1assoc
-                    try:
-                        L1hitTime = df[(df["Cache Size(bytes)"] == L1size) & 
-                                    (df[" Block Size(bytes)"] == 32) &
-                                    (df[" Associativity"] == assoc)][" Access Time(ns)"].item()
-                    except:
-                        if L1assoc == int(L1size/32): assoc = " FA"
-                        L1hitTime = df[(df["Cache Size(bytes)"] == L1size) & 
-                                    (df[" Block Size(bytes)"] == 32) &
-                                    (df[" Associativity"] == assoc)][" Access Time(ns)"].item()
+            L1MR = exp1_rates.get((L1size, L1assoc))
+            if L1MR is None:
+                with open(filename, "r") as file:
+                    L1MR = float(file.readlines()[0])
+            if do_aat:
+                # calculate AAT = L1 hit time + L1 MR . Miss penalty(100 ns)
+                if L1assoc == int(L1size/32): assoc = "FA"
+                else: assoc = L1assoc
+                try:
+                    L1hitTime = df[(df["Cache Size(bytes)"] == L1size) & 
+                                (df[" Block Size(bytes)"] == 32) &
+                                (df[" Associativity"] == assoc)][" Access Time(ns)"].item()
+                except:
+                    if L1assoc == int(L1size/32): assoc = " FA"
+                    L1hitTime = df[(df["Cache Size(bytes)"] == L1size) & 
+                                (df[" Block Size(bytes)"] == 32) &
+                                (df[" Associativity"] == assoc)][" Access Time(ns)"].item()
 
-                    assert type(L1hitTime) == float
-                    AAT = L1hitTime + L1MR * 100
-                    sizewise.append(AAT)
-                else:
-                    sizewise.append(L1MR)
+                assert type(L1hitTime) == float
+                AAT = L1hitTime + L1MR * 100
+                sizewise.append(AAT)
+            else:
+                sizewise.append(L1MR)
         values.append(sizewise)
     x = np.arange(10, 21)
 elif exp == 2:
@@ -0,0 +1,167 @@
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "binary_trace.hpp"
+#include "checkpoint.hpp"
+#include "mapped_file.hpp"
+
+// Geometry and counters of a cache, as saved.
+static CheckpointLevel describe(const Cache &cache)
+{
+     CheckpointLevel level{};
+     level.size = cache.getSize();
+     level.assoc = cache.getAssoc();
+     level.num_sets = cache.getSlab().getNumSets();
+     level.stride = static_cast<std::uint32_t>(cache.getSlab().getStride());
+     level.data_bytes = cache.getData().raw().size();
+     level.accesses = cache.numAccesses;
+     level.reads = cache.reads;
+     level.read_misses = cache.read_misses;
+     level.writes = cache.writes;
+     level.write_misses = cache.write_misses;
+     level.write_backs = cache.write_backs;
+     level.psel = cache.getDueling().getPsel();
+     level.predictor_bytes = static_cast<std::uint32_t>(cache.getPredictor().savedBytes());
+     return level;
+}
+
+bool save_checkpoint(const std::string &path, unsigned int blocksize,
+                     ReplacementPolicy replacement_policy,
+                     InclusionProperty inclusion_property,
+                     InsertionPredictor insertion_predictor, CheckpointPosition position,
+                     std::span<const Cache *const> levels)
+{
+     std::ofstream file(path, std::ios::binary | std::ios::trunc);
+     if (!file.is_open())
+          return false;
+
+     // Reserve room for the header, which needs the payload's size and checksum.
+     CheckpointHeader header{};
+     file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+     TraceChecksum checksum;
+     auto emit = [&](const void *data, std::size_t size)
+     {
+          checksum.update(data, size);
+          file.write(static_cast<const char *>(data), size);
+          header.payload_bytes += size;
+     };
+
+     for (const Cache *cache : levels)
+     {
+          CheckpointLevel level = describe(*cache);
+          emit(&level, sizeof(level));
+          emit(cache->getSlab().raw().data(), cache->getSlab().raw().size());
+          emit(cache->getData().raw().data(), cache->getData().raw().size());
+          std::vector<unsigned char> predictor = cache->getPredictor().save();
+          emit(predictor.data(), predictor.size());
+     }
+
+     std::memcpy(header.magic, CheckpointHeader::MAGIC, sizeof(header.magic));
+     header.version = CheckpointHeader::VERSION;
+     header.num_levels = static_cast<std::uint32_t>(levels.size());
+     header.trace_offset = position.trace_offset;
+     header.trace_checksum = position.trace_checksum;
+     header.checksum = checksum.value();
+     header.blocksize = blocksize;
+     header.replacement_policy = static_cast<std::uint32_t>(replacement_policy);
+     header.inclusion_property = static_cast<std::uint32_t>(inclusion_property);
+     header.insertion_predictor = static_cast<std::uint32_t>(insertion_predictor);
+
+     file.seekp(0);
+     file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+     file.close();
+     return !file.fail();
+}
+
+CheckpointPosition restore_checkpoint(const std::string &path, unsigned int blocksize,
+                                      ReplacementPolicy replacement_policy,
+                                      InclusionProperty inclusion_property,
+                                      InsertionPredictor insertion_predictor,
+                                      std::span<Cache *const> levels)
+{
+     auto fail = [&](const std::string &reason)
+     {
+          return std::invalid_argument("checkpoint " + path + ": " + reason);
+     };
+
+     MappedFile file(path);
+     if (!file.is_open())
+          throw fail("unable to open");
+
+     CheckpointHeader header;
+     if (file.size() < sizeof(header))
+          throw fail("file too small for a checkpoint header");
+     std::memcpy(&header, file.begin(), sizeof(header));
+     if (std::memcmp(header.magic, CheckpointHeader::MAGIC, sizeof(header.magic)) != 0)
+          throw fail("not a checkpoint");
+     if (header.version != CheckpointHeader::VERSION)
+          throw fail("unsupported version " + std::to_string(header.version));
+     if (header.payload_bytes != file.size() - sizeof(header))
+          throw fail("truncated");
+
+     const char *payload = file.begin() + sizeof(header);
+     TraceChecksum checksum;
+     checksum.update(payload, header.payload_bytes);
+     if (checksum.value() != header.checksum)
+          throw fail("checksum mismatch");
+
+     if (header.blocksize != blocksize ||
+         header.replacement_policy != static_cast<std::uint32_t>(replacement_policy) ||
+         header.inclusion_property != static_cast<std::uint32_t>(inclusion_property) ||
+         header.insertion_predictor != static_cast<std::uint32_t>(insertion_predictor) ||
+         header.num_levels != levels.size())
+          throw fail("taken with a different configuration");
+
+     // Check every section before touching any cache, so a mismatch leaves them all cold.
+     const char *cursor = payload;
+     for (const Cache *cache : levels)
+     {
+          CheckpointLevel saved;
+          if (file.end() - cursor < static_cast<std::ptrdiff_t>(sizeof(saved)))
+               throw fail("truncated");
+          std::memcpy(&saved, cursor, sizeof(saved));
+          CheckpointLevel expected = describe(*cache);
+          if (saved.size != expected.size || saved.assoc != expected.assoc ||
+              saved.num_sets != expected.num_sets || saved.stride != expected.stride ||
+              saved.data_bytes != expected.data_bytes ||
+              saved.predictor_bytes != expected.predictor_bytes)
+               throw fail(cache->name + " taken with a different geometry or build");
+          cursor += sizeof(saved) + cache->getSlab().getBytes() + saved.data_bytes +
+                    saved.predictor_bytes;
+     }
+     if (cursor != file.end())
+          throw fail("sections do not match the payload size");
+
+     cursor = payload;
+     for (Cache *cache : levels)
+     {
+          CheckpointLevel saved;
+          std::memcpy(&saved, cursor, sizeof(saved));
+          cursor += sizeof(saved);
+
+          auto records = cache->getSlab().raw();
+          std::memcpy(records.data(), cursor, records.size());
+          cursor += records.size();
+          auto data = cache->getData().raw();
+          if (!data.empty())
+               std::memcpy(data.data(), cursor, data.size());
+          cursor += data.size();
+          cache->getPredictor().restore(std::span<const unsigned char>(
+              reinterpret_cast<const unsigned char *>(cursor), saved.predictor_bytes));
+          cursor += saved.predictor_bytes;
+
+          cache->numAccesses = saved.accesses;
+          cache->reads = saved.reads;
+          cache->read_misses = saved.read_misses;
+          cache->writes = saved.writes;
+          cache->write_misses = saved.write_misses;
+          cache->write_backs = saved.write_backs;
+          cache->getDueling().setPsel(saved.psel);
+          cache->rebuildIndex();
+          cache->restampNextUses();
+     }
+     return {header.trace_offset, header.trace_checksum};
+}
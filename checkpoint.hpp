@@ -0,0 +1,81 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint> // for std::uint32_t, std::uint64_t
+#include <span>    // for std::span
+#include <string>  // for std::string
+
+#include "cache.hpp"
+#include "inclusion_property.hpp"
+#include "insertion_predictor.hpp"
+#include "replacement_policy.hpp"
+
+// Fixed 64-byte little-endian header at the start of every checkpoint. It is followed by one
+// section per cache, main memory last: a CheckpointLevel, the cache's set records byte for
+// byte, its payload bytes if it stores any, then its predictor's state if it has one.
+struct CheckpointHeader
+{
+     static constexpr char MAGIC[8] = {'S', 'I', 'M', 'C', 'K', 'P', 'N', 'T'};
+     static constexpr std::uint32_t VERSION = 4;
+
+     char magic[8];
+     std::uint32_t version;
+     std::uint32_t num_levels;     // Sections that follow
+     std::uint64_t trace_offset;   // Accesses simulated when the checkpoint was taken
+     std::uint64_t payload_bytes;  // Bytes following the header
+     std::uint64_t checksum;       // TraceChecksum of the payload
+     std::uint32_t blocksize;
+     std::uint32_t replacement_policy;
+     std::uint32_t inclusion_property;
+     std::uint32_t insertion_predictor;
+     std::uint64_t trace_checksum; // TraceChecksum of the first trace_offset accesses
+};
+
+static_assert(sizeof(CheckpointHeader) == 64, "Checkpoint header must stay 64 bytes");
+
+// One cache's geometry and counters.
+struct CheckpointLevel
+{
+     std::uint32_t size;
+     std::uint32_t assoc;
+     std::uint32_t num_sets;
+     std::uint32_t stride;       // Bytes per set record
+     std::uint64_t data_bytes;   // Payload bytes; 0 in tag-only mode
+     std::uint32_t accesses;
+     std::uint32_t reads;
+     std::uint32_t read_misses;
+     std::uint32_t writes;
+     std::uint32_t write_misses;
+     std::uint32_t write_backs;
+     std::uint32_t psel;         // DRRIP's dueling selector
+     std::uint32_t predictor_bytes; // Hit predictor state; 0 without one
+     std::uint32_t reserved[2];
+};
+
+static_assert(sizeof(CheckpointLevel) == 64, "Checkpoint level must stay 64 bytes");
+
+// How far into which trace a checkpoint was taken.
+struct CheckpointPosition
+{
+     std::uint64_t trace_offset;   // Accesses simulated
+     std::uint64_t trace_checksum; // TraceChecksum of those accesses
+};
+
+// Writes the state of `levels` at `position`. Returns false if the file cannot be written.
+bool save_checkpoint(const std::string &path, unsigned int blocksize,
+                     ReplacementPolicy replacement_policy,
+                     InclusionProperty inclusion_property,
+                     InsertionPredictor insertion_predictor, CheckpointPosition position,
+                     std::span<const Cache *const> levels);
+
+// Restores `levels`, built with the configuration the checkpoint was taken with, and returns
+// its position. The caller checks that its trace starts with the accesses it covers. Throws
+// std::invalid_argument if the file is missing, corrupt, of another version or of another
+// configuration.
+CheckpointPosition restore_checkpoint(const std::string &path, unsigned int blocksize,
+                                      ReplacementPolicy replacement_policy,
+                                      InclusionProperty inclusion_property,
+                                      InsertionPredictor insertion_predictor,
+                                      std::span<Cache *const> levels);
+
+#endif // CHECKPOINT_HPP
@@ -0,0 +1,11 @@
+#ifndef INSERTION_PREDICTOR_HPP
+#define INSERTION_PREDICTOR_HPP
+
+enum class InsertionPredictor
+{
+     None = 0,  // Every miss fills at the policy's own insertion priority
+     SHiP = 1,  // Predicted-dead fills go in at distant re-reference
+     Bypass = 2 // Predicted-dead misses skip the cache
+};
+
+#endif // INSERTION_PREDICTOR_HPP
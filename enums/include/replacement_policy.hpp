@@ -3,11 +3,23 @@
 
 enum class ReplacementPolicy
 {
-     LRU = 0,    // Least Recently Used
-     FIFO = 1,   // First In, First Out
-     Optimal = 2 // Optimal Replacement Policy
+     LRU = 0,      // Least Recently Used
+     FIFO = 1,     // First In, First Out
+     Optimal = 2,  // Optimal Replacement Policy
+     TreePLRU = 3, // Tree pseudo-LRU, power-of-two associativity up to 64
+     BitPLRU = 4,  // Bit (MRU-bit) pseudo-LRU, associativity up to 64
+     SRRIP = 5,    // Static re-reference interval prediction
+     BRRIP = 6,    // Bimodal RRIP, for scans and thrashing
+     DRRIP = 7     // Dynamic RRIP: SRRIP or BRRIP by set dueling
 };
 
+// Whether `policy` keeps a re-reference prediction value per way.
+constexpr bool isRRIP(ReplacementPolicy policy)
+{
+     return policy == ReplacementPolicy::SRRIP || policy == ReplacementPolicy::BRRIP ||
+            policy == ReplacementPolicy::DRRIP;
+}
+
 // Comparison function to check if an enum is equal to an unsigned short.
 inline bool operator==(ReplacementPolicy policy, unsigned short value)
 {
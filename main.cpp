@@ -5,20 +5,34 @@
 #include <cstdlib>
 #include <limits>
 #include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <sstream>
 
 // Enums
 #include "replacement_policy.hpp"
 #include "inclusion_property.hpp"
+#include "insertion_predictor.hpp"
 
 // Local libraries
+#include "binary_trace.hpp"
 #include "cache.hpp"
 #include "instruction.hpp"
+#include "loaded_trace.hpp"
 #include "mem_architecture_sim.hpp"
+#include "stack_distance.hpp"
+#include "trace_format.hpp"
+#include "trace_stream.hpp"
+#include "work_stealing_pool.hpp"
 
 // Global constants
 #define DECIMAL 10
 #define DIRECT_MAPPED 1
 #define FORMAT_SPACE 23
+#define BINARY_CHUNK (1 << 16)
+#define FULLY_ASSOCIATIVE 0 // Placeholder assoc in grid lists, resolved per size
 const bool DEBUG = true;
 
 // Convert string to unsigned int with error checking.
@@ -46,14 +60,557 @@ void out(std::string var, std::string val)
      cout << setw(0);
 }
 
+void usage(const char *program)
+{
+     std::cerr << "Usage: " << program << " <BLOCKSIZE> <L1_SIZE> <L1_ASSOC> "
+               << "<L2_SIZE> <L2_ASSOC> <REPLACEMENT_POLICY> <INCLUSION_PROPERTY> " 
+               << "<trace_file> [options]" << std::endl;
+     std::cerr << "       " << program << " convert <text_trace> <binary_trace> [--delta]"
+               << std::endl;
+     std::cerr << "       " << program << " sweep <BLOCKSIZE> <MIN_L1_SIZE> <MAX_L1_SIZE> "
+               << "<trace_file> [--sample-rate R] [--sample-budget N]" << std::endl;
+     std::cerr << "       " << program << " grid <BLOCKSIZE> <L1_SIZES> <L1_ASSOCS> "
+               << "<L2_SIZES> <L2_ASSOCS> <REPLACEMENT_POLICIES> <INCLUSION_PROPERTIES> "
+               << "<trace_file> [--threads N] [--json]" << std::endl;
+     std::cerr << "Replacement policies: 0 LRU, 1 FIFO, 2 optimal, 3 tree-PLRU, 4 bit-PLRU, "
+               << "5 SRRIP, 6 BRRIP, 7 DRRIP" << std::endl;
+     std::cerr << "Options:" << std::endl;
+     std::cerr << "  --stream            parse and simulate in bounded chunks (LRU/FIFO)"
+               << std::endl;
+     std::cerr << "  --parse-threads N   threads for text trace parsing (default: all cores)"
+               << std::endl;
+     std::cerr << "  --block-data        store block payloads (default: tags and state only)"
+               << std::endl;
+     std::cerr << "  --set-threads N     simulate disjoint L1 set ranges on N threads "
+               << "(no L2)" << std::endl;
+     std::cerr << "  --pipeline          simulate L2 and memory on a second thread "
+               << "(non-inclusive)" << std::endl;
+     std::cerr << "  --record-l1 FILE    save L1's requests to the next level as a binary trace;"
+               << std::endl;
+     std::cerr << "                      replay it with L1_SIZE 0 into non-inclusive L2s"
+               << std::endl;
+     std::cerr << "  --time-chunks K     simulate K trace slices at once from cold caches "
+               << "(approximate)" << std::endl;
+     std::cerr << "  --warmup N          warm each slice on the N accesses before it "
+               << "(default: 0)" << std::endl;
+     std::cerr << "  --validate          report the time-parallel error against a serial run"
+               << std::endl;
+     std::cerr << "  --checkpoint FILE   save the cache state and trace position after the run"
+               << std::endl;
+     std::cerr << "  --restore FILE      resume from a checkpoint of the same configuration, "
+               << "skipping the accesses it covers" << std::endl;
+     std::cerr << "  --predictor ship    insert blocks the last level predicts dead at distant "
+               << "re-reference (RRIP)" << std::endl;
+     std::cerr << "  --predictor bypass  skip the last level for blocks it predicts dead"
+               << std::endl;
+     std::cerr << "Sweep options:" << std::endl;
+     std::cerr << "  --sample-rate R     estimate from a hash sample of R of the sets or blocks"
+               << std::endl;
+     std::cerr << "  --sample-budget N   track at most N blocks, lowering the rate as needed"
+               << std::endl;
+     std::cerr << "Grid options (lists are comma-separated; \"full\" is a fully associative "
+               << "assoc):" << std::endl;
+     std::cerr << "  --threads N         simulation threads (default: all cores)" << std::endl;
+     std::cerr << "  --json              print a JSON array instead of CSV" << std::endl;
+}
+
+// Convert a text trace into the binary format, one parsed chunk at a time.
+int convertTrace(int argc, char *argv[])
+{
+     if (argc < 4 || argc > 5 || (argc == 5 && std::string(argv[4]) != "--delta"))
+     {
+          usage(argv[0]);
+          return 1;
+     }
+
+     std::string text_file = argv[2];
+     std::string binary_file = argv[3];
+     TraceEncoding encoding = (argc == 5) ? TraceEncoding::Delta : TraceEncoding::Raw;
+
+     TraceStream stream(text_file);
+     if (!stream.is_open())
+     {
+          std::cerr << "Error: Unable to open trace file: " << text_file << std::endl;
+          return 1;
+     }
+
+     BinaryTraceWriter writer(binary_file, encoding);
+     if (!writer.is_open())
+     {
+          std::cerr << "Error: Unable to create binary trace: " << binary_file << std::endl;
+          return 1;
+     }
+
+     stream.start();
+     while (auto chunk = stream.next())
+     {
+          writer.write(*chunk);
+          stream.release(chunk);
+     }
+
+     if (!writer.close())
+     {
+          std::cerr << "Error: Failed writing binary trace: " << binary_file << std::endl;
+          return 1;
+     }
+
+     stream.getStats().report(std::cerr);
+     std::cerr << "Wrote " << writer.getCount() << " accesses in "
+               << sizeof(BinaryTraceHeader) + writer.getPayloadBytes() << " bytes ("
+               << ((encoding == TraceEncoding::Delta) ? "delta" : "raw") << ")" << std::endl;
+     return 0;
+}
+
+// Feed every access of a trace, in any supported format, to the sweep.
+bool sweepAccesses(const std::string &trace_file, StackDistance &sweep)
+{
+     if (detect_trace_format(trace_file) == TraceFormat::Binary)
+     {
+          BinaryTrace trace;
+          std::string error;
+          if (!trace.open(trace_file, error) || !trace.verify())
+          {
+               std::cerr << "Error: " << trace_file << ": "
+                         << (error.empty() ? "checksum mismatch" : error) << std::endl;
+               return false;
+          }
+
+          if (trace.getEncoding() == TraceEncoding::Raw)
+          {
+               sweep.add(trace.records());
+               return true;
+          }
+
+          // Delta payloads are decoded into one reusable chunk at a time.
+          std::vector<Instruction> chunk;
+          for (;;)
+          {
+               chunk.clear();
+               if (trace.decode(chunk, BINARY_CHUNK) == 0) break;
+               sweep.add(chunk);
+          }
+          return true;
+     }
+
+     TraceStream stream(trace_file);
+     if (!stream.is_open())
+     {
+          std::cerr << "Error: Unable to open trace file: " << trace_file << std::endl;
+          return false;
+     }
+
+     stream.start();
+     while (auto chunk = stream.next())
+     {
+          sweep.add(*chunk);
+          stream.release(chunk);
+     }
+     stream.getStats().report(std::cerr);
+     return true;
+}
+
+// Convert string to a fraction in (0, 1] with error checking.
+double convertToRate(const char *arg)
+{
+     char *end;
+     double val = std::strtod(arg, &end);
+     if (*end != '\0' || !(val > 0.0 && val <= 1.0))
+     {
+          std::cerr << "Error: Argument (" << arg << ") is not a rate in (0, 1]." << std::endl;
+          exit(1);
+     }
+     return val;
+}
+
+// Print LRU miss counts of every power-of-two L1 size and associativity, from one pass.
+// Sampling options switch to estimates in bounded memory.
+int sweepTrace(int argc, char *argv[])
+{
+     if (argc < 6)
+     {
+          usage(argv[0]);
+          return 1;
+     }
+
+     unsigned int blocksize = convertToUnsignedInt(argv[2]);
+     unsigned int min_size = convertToUnsignedInt(argv[3]);
+     unsigned int max_size = convertToUnsignedInt(argv[4]);
+     std::string trace_file = argv[5];
+
+     SweepSampling sampling;
+     for (int i = 6; i < argc; i++)
+     {
+          std::string option = argv[i];
+          if (option == "--sample-rate" && i + 1 < argc)
+               sampling.rate = convertToRate(argv[++i]);
+          else if (option == "--sample-budget" && i + 1 < argc)
+               sampling.budget = convertToUnsignedInt(argv[++i]);
+          else
+          {
+               std::cerr << "Error: Unknown option: " << option << std::endl;
+               usage(argv[0]);
+               return 1;
+          }
+     }
+
+     try
+     {
+          StackDistance sweep(blocksize, min_size, max_size, sampling);
+          if (!sweepAccesses(trace_file, sweep))
+               return 1;
+          if (sweep.isSampled())
+               std::cerr << "Sampled: " << sweep.getNumTracked() << " blocks tracked of "
+                         << sweep.getNumAccesses() << " accesses, lowest rate "
+                         << sweep.getMinRate() << std::endl;
+          sweep.print(std::cout);
+     }
+     catch (const std::invalid_argument &e)
+     {
+          std::cerr << "Error: " << e.what() << std::endl;
+          return 1;
+     }
+     return 0;
+}
+
+// One cache level's results, as the single-run report lists them.
+struct LevelCounts
+{
+     unsigned int reads = 0;
+     unsigned int read_misses = 0;
+     unsigned int writes = 0;
+     unsigned int write_misses = 0;
+     double miss_rate = 0.0;
+     unsigned int write_backs = 0;
+};
+
+// One point of a configuration grid and, once simulated, its results.
+struct GridConfig
+{
+     std::vector<unsigned int> sizes; // L1, L2
+     std::vector<unsigned int> assocs;
+     unsigned int policy;
+     unsigned int property;
+
+     bool done = false;
+     std::string error;
+     std::vector<LevelCounts> counts; // Per level; zero for an absent level
+     unsigned int memory_traffic = 0;
+};
+
+const char *policyName(unsigned int policy)
+{
+     switch (static_cast<ReplacementPolicy>(policy))
+     {
+          case ReplacementPolicy::LRU: return "LRU";
+          case ReplacementPolicy::FIFO: return "FIFO";
+          case ReplacementPolicy::Optimal: return "optimal";
+          case ReplacementPolicy::TreePLRU: return "tree-PLRU";
+          case ReplacementPolicy::BitPLRU: return "bit-PLRU";
+          case ReplacementPolicy::SRRIP: return "SRRIP";
+          case ReplacementPolicy::BRRIP: return "BRRIP";
+          case ReplacementPolicy::DRRIP: return "DRRIP";
+     }
+     return "unknown";
+}
+
+const char *propertyName(unsigned int property)
+{
+     switch (static_cast<InclusionProperty>(property))
+     {
+          case InclusionProperty::NonInclusive: return "non-inclusive";
+          case InclusionProperty::Inclusive: return "inclusive";
+     }
+     return "unknown";
+}
+
+// Split a comma-separated list of unsigned ints. FULLY_ASSOCIATIVE stands in for "full".
+std::vector<unsigned int> convertToList(const char *arg, bool allow_full = false)
+{
+     std::vector<unsigned int> values;
+     std::stringstream list(arg);
+     std::string item;
+     while (std::getline(list, item, ','))
+     {
+          if (allow_full && item == "full")
+               values.push_back(FULLY_ASSOCIATIVE);
+          else
+               values.push_back(convertToUnsignedInt(item.c_str()));
+     }
+     if (values.empty())
+     {
+          std::cerr << "Error: Argument (" << arg << ") is an empty list." << std::endl;
+          exit(1);
+     }
+     return values;
+}
+
+// Every combination of the lists. An absent L2 takes no associativity, so it is listed once.
+std::vector<GridConfig> expandGrid(unsigned int blocksize,
+                                   const std::vector<std::vector<unsigned int>> &lists)
+{
+     std::vector<GridConfig> grid;
+     for (unsigned int l1_size : lists[0])
+     for (unsigned int l1_assoc : lists[1])
+     for (unsigned int l2_size : lists[2])
+     for (unsigned int l2_assoc : (l2_size == 0) ? std::vector<unsigned int>{0} : lists[3])
+     for (unsigned int policy : lists[4])
+     for (unsigned int property : lists[5])
+     {
+          GridConfig config;
+          config.sizes = {l1_size, l2_size};
+          config.assocs = {l1_assoc, l2_assoc};
+          for (std::size_t i = 0; i < config.sizes.size(); i++)
+               if (config.assocs[i] == FULLY_ASSOCIATIVE)
+                    config.assocs[i] = config.sizes[i] / blocksize;
+          config.policy = policy;
+          config.property = property;
+          grid.push_back(config);
+     }
+     return grid;
+}
+
+// Simulate one configuration quietly over the shared trace.
+void simulateConfig(GridConfig &config, unsigned int blocksize,
+                    std::span<const Instruction> trace)
+{
+     try
+     {
+          unsigned int main_memory_size = 0;
+          for (unsigned int cache_size : config.sizes) main_memory_size += cache_size;
+          Cache main_memory("MAIN_MEMORY", blocksize, main_memory_size, DIRECT_MAPPED,
+                            static_cast<ReplacementPolicy>(config.policy),
+                            static_cast<InclusionProperty>(config.property),
+                            std::span<const Instruction>(), false);
+
+          MemArchitectureSim simulator(blocksize, config.sizes, config.assocs, config.policy,
+                                       config.property, trace, main_memory);
+
+          std::size_t level = 0;
+          config.counts.resize(config.sizes.size());
+          for (std::size_t i = 0; i < config.sizes.size(); i++)
+          {
+               if (config.sizes[i] == 0) continue;
+               const Cache &cache = simulator.getCaches()[level++];
+               config.counts[i] = {cache.reads, cache.read_misses, cache.writes,
+                                   cache.write_misses, cache.miss_rate, cache.write_backs};
+          }
+          config.memory_traffic = simulator.getMemoryTraffic();
+          config.done = true;
+     }
+     catch (const std::invalid_argument &e)
+     {
+          config.error = e.what();
+     }
+}
+
+// Write the simulated configurations as CSV, or as a JSON array of flat objects.
+void printGrid(const std::vector<GridConfig> &grid, unsigned int blocksize, bool json)
+{
+     static const char *COLUMNS[] = {"reads", "read_misses", "writes", "write_misses",
+                                     "miss_rate", "writebacks"};
+
+     std::vector<std::string> keys = {"blocksize", "l1_size", "l1_assoc", "l2_size",
+                                      "l2_assoc", "replacement", "inclusion"};
+     for (std::string level : {"l1_", "l2_"})
+          for (const char *column : COLUMNS)
+               keys.push_back(level + column);
+     keys.push_back("memory_traffic");
+
+     if (json)
+          std::cout << "[" << std::endl;
+     else
+     {
+          for (std::size_t k = 0; k < keys.size(); k++)
+               std::cout << (k ? "," : "") << keys[k];
+          std::cout << std::endl;
+     }
+
+     bool first = true;
+     for (const auto &config : grid)
+     {
+          if (!config.done) continue;
+
+          std::vector<std::string> values = {
+              std::to_string(blocksize),
+              std::to_string(config.sizes[0]), std::to_string(config.assocs[0]),
+              std::to_string(config.sizes[1]), std::to_string(config.assocs[1]),
+              policyName(config.policy), propertyName(config.property)};
+          for (const auto &counts : config.counts)
+          {
+               values.push_back(std::to_string(counts.reads));
+               values.push_back(std::to_string(counts.read_misses));
+               values.push_back(std::to_string(counts.writes));
+               values.push_back(std::to_string(counts.write_misses));
+               values.push_back(std::to_string(counts.miss_rate));
+               values.push_back(std::to_string(counts.write_backs));
+          }
+          values.push_back(std::to_string(config.memory_traffic));
+
+          if (json)
+          {
+               std::cout << (first ? "  {" : ",\n  {");
+               for (std::size_t k = 0; k < keys.size(); k++)
+               {
+                    bool text = (k == 5 || k == 6); // replacement, inclusion
+                    std::cout << (k ? ", " : "") << "\"" << keys[k] << "\": "
+                              << (text ? "\"" : "") << values[k] << (text ? "\"" : "");
+               }
+               std::cout << "}";
+          }
+          else
+          {
+               for (std::size_t k = 0; k < values.size(); k++)
+                    std::cout << (k ? "," : "") << values[k];
+               std::cout << std::endl;
+          }
+          first = false;
+     }
+
+     if (json)
+          std::cout << (first ? "]" : "\n]") << std::endl;
+}
+
+// Simulate every configuration of a grid over one parsed copy of the trace, in parallel, and
+// print a single results table.
+int gridTrace(int argc, char *argv[])
+{
+     if (argc < 10)
+     {
+          usage(argv[0]);
+          return 1;
+     }
+
+     unsigned int blocksize = convertToUnsignedInt(argv[2]);
+     std::vector<std::vector<unsigned int>> lists = {
+         convertToList(argv[3]), convertToList(argv[4], true),
+         convertToList(argv[5]), convertToList(argv[6], true),
+         convertToList(argv[7]), convertToList(argv[8])};
+     std::string trace_file = argv[9];
+
+     unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+     bool json = false;
+     for (int i = 10; i < argc; i++)
+     {
+          std::string option = argv[i];
+          if (option == "--threads" && i + 1 < argc)
+               threads = std::max(1u, convertToUnsignedInt(argv[++i]));
+          else if (option == "--json")
+               json = true;
+          else
+          {
+               std::cerr << "Error: Unknown option: " << option << std::endl;
+               usage(argv[0]);
+               return 1;
+          }
+     }
+
+     LoadedTrace trace;
+     if (!trace.load(trace_file, threads))
+          return 1;
+     trace.getStats().report(std::cerr);
+
+     std::vector<GridConfig> grid = expandGrid(blocksize, lists);
+
+     // Deal the costliest configurations first: optimal replacement, then the most ways.
+     std::vector<std::size_t> order(grid.size());
+     for (std::size_t i = 0; i < order.size(); i++) order[i] = i;
+     auto cost = [&](std::size_t i)
+     {
+          const GridConfig &config = grid[i];
+          bool optimal =
+              static_cast<ReplacementPolicy>(config.policy) == ReplacementPolicy::Optimal;
+          return std::make_pair(optimal, config.assocs[0] + config.assocs[1]);
+     };
+     std::stable_sort(order.begin(), order.end(),
+                      [&](std::size_t a, std::size_t b) { return cost(a) > cost(b); });
+
+     WorkStealingPool pool(std::min<std::size_t>(threads, std::max<std::size_t>(1, grid.size())));
+     auto start = std::chrono::steady_clock::now();
+     pool.run(order.size(), [&](std::size_t i)
+              { simulateConfig(grid[order[i]], blocksize, trace.instructions()); });
+     std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+     for (const auto &config : grid)
+          if (!config.done)
+               std::cerr << "Skipped " << config.sizes[0] << "/" << config.assocs[0] << " "
+                         << config.sizes[1] << "/" << config.assocs[1] << " "
+                         << policyName(config.policy) << " " << propertyName(config.property)
+                         << ": " << config.error << std::endl;
+
+     double seconds = elapsed.count();
+     double accesses = static_cast<double>(trace.instructions().size()) * grid.size();
+     std::cerr << "Grid: " << grid.size() << " configurations on " << pool.getNumThreads()
+               << " threads in " << std::fixed << std::setprecision(3) << seconds << " s ("
+               << std::setprecision(0) << ((seconds > 0.0) ? accesses / seconds : 0.0)
+               << " accesses/s)" << std::endl;
+     std::cerr << std::defaultfloat;
+
+     printGrid(grid, blocksize, json);
+     return 0;
+}
+
+// Parse the optional flags that follow the positional arguments.
+SimOptions parseOptions(int argc, char *argv[], int first)
+{
+     SimOptions options;
+     options.parse_threads = std::max(1u, std::thread::hardware_concurrency());
+     for (int i = first; i < argc; i++)
+     {
+          std::string option = argv[i];
+          if (option == "--stream") options.stream = true;
+          else if (option == "--block-data") options.block_data = true;
+          else if (option == "--pipeline") options.pipeline = true;
+          else if (option == "--record-l1" && i + 1 < argc)
+               options.record_file = argv[++i];
+          else if (option == "--time-chunks" && i + 1 < argc)
+               options.time_chunks = std::max(1u, convertToUnsignedInt(argv[++i]));
+          else if (option == "--warmup" && i + 1 < argc)
+               options.warmup = convertToUnsignedInt(argv[++i]);
+          else if (option == "--validate") options.validate = true;
+          else if (option == "--checkpoint" && i + 1 < argc)
+               options.checkpoint_file = argv[++i];
+          else if (option == "--restore" && i + 1 < argc)
+               options.restore_file = argv[++i];
+          else if (option == "--parse-threads" && i + 1 < argc)
+               options.parse_threads = std::max(1u, convertToUnsignedInt(argv[++i]));
+          else if (option == "--set-threads" && i + 1 < argc)
+               options.set_threads = std::max(1u, convertToUnsignedInt(argv[++i]));
+          else if (option == "--predictor" && i + 1 < argc)
+          {
+               std::string mode = argv[++i];
+               if (mode == "ship") options.predictor = InsertionPredictor::SHiP;
+               else if (mode == "bypass") options.predictor = InsertionPredictor::Bypass;
+               else
+               {
+                    std::cerr << "Error: Unknown predictor: " << mode << std::endl;
+                    usage(argv[0]);
+                    exit(1);
+               }
+          }
+          else
+          {
+               std::cerr << "Error: Unknown option: " << option << std::endl;
+               usage(argv[0]);
+               exit(1);
+          }
+     }
+     return options;
+}
+
 int main(int argc, char *argv[])
 {
+     // Subcommands
+     if (argc > 1 && std::string(argv[1]) == "convert")
+          return convertTrace(argc, argv);
+     if (argc > 1 && std::string(argv[1]) == "sweep")
+          return sweepTrace(argc, argv);
+     if (argc > 1 && std::string(argv[1]) == "grid")
+          return gridTrace(argc, argv);
+
      // Check input parameters.
-     if (argc != 9)
+     if (argc < 9)
      {
-          std::cerr << "Usage: " << argv[0] << " <BLOCKSIZE> <L1_SIZE> <L1_ASSOC> "
-                    << "<L2_SIZE> <L2_ASSOC> <REPLACEMENT_POLICY> <INCLUSION_PROPERTY> " 
-                    << "<trace_file>" << std::endl;
+          usage(argv[0]);
           return 1;
      }
 
@@ -66,23 +623,11 @@ int main(int argc, char *argv[])
      unsigned int REPLACEMENT_POLICY = convertToUnsignedInt(argv[6]);
      unsigned int INCLUSION_PROPERTY = convertToUnsignedInt(argv[7]);
      std::string trace_file = argv[8];
+     SimOptions options = parseOptions(argc, argv, 9);
 
      // Decode input.
-     ReplacementPolicy policy = static_cast<ReplacementPolicy>(REPLACEMENT_POLICY);
-     InclusionProperty property = static_cast<InclusionProperty>(INCLUSION_PROPERTY);
-     std::string replacement_policy;
-     std::string inclusion_property;
-     switch (policy)
-     {
-          case ReplacementPolicy::LRU: replacement_policy = "LRU"; break;
-          case ReplacementPolicy::FIFO: replacement_policy = "FIFO"; break;
-          case ReplacementPolicy::Optimal: replacement_policy = "optimal"; break;
-     }
-     switch (property)
-     {
-          case InclusionProperty::NonInclusive: inclusion_property = "non-inclusive"; break;
-          case InclusionProperty::Inclusive: inclusion_property = "inclusive"; break;
-     }
+     std::string replacement_policy = policyName(REPLACEMENT_POLICY);
+     std::string inclusion_property = propertyName(INCLUSION_PROPERTY);
 
      // Display input parameters.
      std::cout << "===== Simulator configuration =====" << std::endl;
@@ -94,6 +639,9 @@ int main(int argc, char *argv[])
      out("REPLACEMENT POLICY:", replacement_policy);
      out("INCLUSION PROPERTY:", inclusion_property);
      out("trace_file:", trace_file);
+     if (options.predictor != InsertionPredictor::None)
+          out("LLC PREDICTOR:",
+              options.predictor == InsertionPredictor::SHiP ? "SHiP" : "SHiP bypass");
 
      std::vector<unsigned int> CACHE_SIZES = {L1_SIZE, L2_SIZE};
      std::vector<unsigned int> CACHE_ASSOCS = {L1_ASSOC, L2_ASSOC};
@@ -102,28 +650,38 @@ int main(int argc, char *argv[])
      unsigned int main_memory_size = 0;
      std::vector<Instruction> mem_instructions;
      for (unsigned int cache_size : CACHE_SIZES) main_memory_size += cache_size;
-     Cache main_memory = Cache(
-         "MAIN_MEMORY",
-         BLOCKSIZE,
-         main_memory_size,
-         DIRECT_MAPPED,
-         static_cast<ReplacementPolicy>(REPLACEMENT_POLICY),
-         static_cast<InclusionProperty>(INCLUSION_PROPERTY),
-         mem_instructions,
-         DEBUG
-     );
-
-     // Construct cache simulator.
-     MemArchitectureSim simulator(
-          BLOCKSIZE,
-          CACHE_SIZES,
-          CACHE_ASSOCS,
-          REPLACEMENT_POLICY,
-          INCLUSION_PROPERTY,
-          trace_file,
-          main_memory,
-          DEBUG
-     );
+     // Cache geometries are validated on construction.
+     try
+     {
+          Cache main_memory = Cache(
+              "MAIN_MEMORY",
+              BLOCKSIZE,
+              main_memory_size,
+              DIRECT_MAPPED,
+              static_cast<ReplacementPolicy>(REPLACEMENT_POLICY),
+              static_cast<InclusionProperty>(INCLUSION_PROPERTY),
+              mem_instructions,
+              DEBUG
+          );
+
+          // Construct cache simulator.
+          MemArchitectureSim simulator(
+               BLOCKSIZE,
+               CACHE_SIZES,
+               CACHE_ASSOCS,
+               REPLACEMENT_POLICY,
+               INCLUSION_PROPERTY,
+               trace_file,
+               main_memory,
+               DEBUG,
+               options
+          );
+     }
+     catch (const std::invalid_argument &e)
+     {
+          std::cerr << "Error: " << e.what() << std::endl;
+          return 1;
+     }
 
      return 0;
 }
@@ -1,14 +1,17 @@
 // External libraries
 #include <iostream>
 #include <iomanip>
-#include <fstream>
+#include <chrono>
 #include <optional>
+#include <algorithm>
 #include <functional>
-#include <sstream>
+#include <mutex>
+#include <stdexcept>
 #include <vector>
 
 // Local enums
 #include "inclusion_property.hpp"
+#include "insertion_predictor.hpp"
 #include "replacement_policy.hpp"
 #include "memory_access.hpp"
 
@@ -16,10 +19,15 @@
 #include "block.hpp"
 #include "cache.hpp"
 #include "mem_architecture_sim.hpp"
+#include "checkpoint.hpp"
+#include "binary_trace.hpp"
+#include "loaded_trace.hpp"
+#include "trace_format.hpp"
+#include "trace_stream.hpp"
+#include "work_stealing_pool.hpp"
 
 // Global constants
 #define DIRECT_MAPPED 1
-#define HEX 16
 #define MISS std::nullopt
 #define EMPTY_BLOCK std::nullopt
 #define L1 0
@@ -28,6 +36,10 @@
 #define VERBOSE true
 #define LAST_INSTRUCTION 200
 #define SPACES 30
+#define BYTES_PER_MB (1024.0 * 1024.0)
+#define BINARY_CHUNK (1 << 16)
+#define RANGES_PER_THREAD 4
+#define VALIDATE_DIGITS 12
 
 // Constructor for MemArchitectureSim
 MemArchitectureSim::MemArchitectureSim(unsigned int blocksize,
@@ -35,68 +47,218 @@ MemArchitectureSim::MemArchitectureSim(unsigned int blocksize,
                                        const std::vector<unsigned int> &cache_assocs,
                                        unsigned int repl_policy, unsigned int incl_property,
                                        const std::string &trace_file, Cache &main_memory,
-                                       bool debug)
+                                       bool debug, const SimOptions &options)
 
     : blocksize(blocksize), cache_sizes(cache_sizes), cache_assocs(cache_assocs),
       replacement_policy(replacement_policy), inclusion_property(inclusion_property),
-      trace_file(trace_file), main_memory(main_memory), memory_traffic(0), debug(debug)
+      trace_file(trace_file), main_memory(main_memory), memory_traffic(0), debug(debug),
+      options(options), numExecuted(0)
 {
 
      inclusion_property = static_cast<InclusionProperty>(incl_property);
      replacement_policy = static_cast<ReplacementPolicy>(repl_policy);
 
-     readInstructions();
+     // Optimal replacement looks ahead through the whole trace, so it cannot be streamed.
+     bool streaming = options.stream;
+     if (streaming && replacement_policy == ReplacementPolicy::Optimal)
+     {
+          std::cerr << "Note: optimal replacement needs the full trace; "
+                    << "streaming disabled." << std::endl;
+          streaming = false;
+     }
+
+     // L1 only hands requests down, so the levels below it can run on their own thread, and
+     // the same request stream can be recorded. An inclusive L2 invalidates L1 blocks on
+     // eviction, which needs the levels in lockstep and makes the stream depend on the L2.
+     std::size_t levels = std::count_if(cache_sizes.begin(), cache_sizes.end(),
+                                        [](unsigned int size) { return size > 0; });
+     bool pipelined = options.pipeline;
+     bool recording = !options.record_file.empty();
+     if (pipelined && levels < 2)
+     {
+          std::cerr << "Note: pipelining needs an L2; disabled." << std::endl;
+          pipelined = false;
+     }
+     if ((pipelined || recording) && levels > 1 &&
+         inclusion_property == InclusionProperty::Inclusive)
+     {
+          std::cerr << "Note: inclusive back-invalidation needs the levels in lockstep; "
+                    << "pipelining and recording disabled." << std::endl;
+          pipelined = recording = false;
+     }
+     if (recording && replacement_policy == ReplacementPolicy::Optimal)
+          std::cerr << "Note: optimal lower levels look ahead in the full trace, so a replay "
+                    << "of the recorded requests into them is not exact." << std::endl;
+     // Contiguous slices of the trace can run at once from cold caches, each warmed on the
+     // accesses before it. Counts near the slice boundaries are then approximate.
+     bool time_parallel = options.time_chunks > 1;
+     bool restoring = !options.restore_file.empty();
+     if (time_parallel && (streaming || recording || restoring))
+     {
+          std::cerr << "Note: time-parallel simulation needs the whole trace in order; "
+                    << "disabled." << std::endl;
+          time_parallel = false;
+     }
+     if (time_parallel && pipelined)
+     {
+          std::cerr << "Note: time-parallel chunks already use the cores; "
+                    << "pipelining disabled." << std::endl;
+          pipelined = false;
+     }
+     if (time_parallel && debug)
+          std::cerr << "Note: per-access output is not printed when chunks run in parallel."
+                    << std::endl;
+
+     // The predictor sits at the last level. An inclusive one must hold every block above it,
+     // so it cannot be bypassed; predicted-dead blocks are inserted at low priority instead.
+     if (this->options.predictor == InsertionPredictor::Bypass && levels > 1 &&
+         inclusion_property == InclusionProperty::Inclusive)
+     {
+          std::cerr << "Note: an inclusive last level holds every block above it; "
+                    << "bypass disabled, using SHiP insertion." << std::endl;
+          this->options.predictor = InsertionPredictor::SHiP;
+     }
+     if (this->options.predictor == InsertionPredictor::SHiP && !isRRIP(replacement_policy))
+          std::cerr << "Note: only RRIP policies have an insertion priority; "
+                    << "the SHiP predictor only learns and counts." << std::endl;
+
+     pipelined = pipelined || recording;
+     if (pipelined && debug)
+     {
+          std::cerr << "Note: per-access output is not printed when levels run in parallel."
+                    << std::endl;
+          this->debug = false;
+     }
+
+     if (!streaming)
+          readInstructions();
      // printInstructions();
 
      numCaches = cache_sizes.size();
      constructCaches();
+     if (restoring)
+          restoreCheckpoint();
 
-     if (debug) 
-          print_debug();
-     else 
-          executeInstructions();
+     // Sets only interact through the levels below them, so only one level can be split.
+     bool partitioned = options.set_threads > 1 && !streaming;
+     if (partitioned && numCaches > 1)
+     {
+          std::cerr << "Note: sets of different levels interact; "
+                    << "set-parallel simulation disabled." << std::endl;
+          partitioned = false;
+     }
+     if (partitioned && this->options.predictor != InsertionPredictor::None)
+     {
+          std::cerr << "Note: the hit predictor's table is shared by all sets; "
+                    << "set-parallel simulation disabled." << std::endl;
+          partitioned = false;
+     }
+     if (partitioned && replacement_policy == ReplacementPolicy::DRRIP)
+     {
+          std::cerr << "Note: DRRIP's sets share one dueling selector; "
+                    << "set-parallel simulation disabled." << std::endl;
+          partitioned = false;
+     }
+     if (partitioned && (recording || restoring))
+     {
+          std::cerr << "Note: recording and resuming need the accesses in trace order; "
+                    << "set-parallel simulation disabled." << std::endl;
+          partitioned = false;
+     }
+     if (partitioned && time_parallel)
+     {
+          std::cerr << "Note: time-parallel chunks already use the cores; "
+                    << "set-parallel simulation disabled." << std::endl;
+          partitioned = false;
+     }
+     if (partitioned && debug)
+          std::cerr << "Note: per-access output is not printed when sets run in parallel."
+                    << std::endl;
+
+     auto start = std::chrono::steady_clock::now();
+     if (pipelined)
+          startPipeline(recording);
+     try
+     {
+          if (streaming)
+               streamInstructions();
+          else if (partitioned)
+               executePartitioned();
+          else if (time_parallel)
+               executeTimeParallel();
+          else if (debug) 
+               print_debug();
+          else 
+               executeInstructions();
+     }
+     catch (...)
+     {
+          // A checkpoint taken on another trace is only found out once its prefix is read.
+          if (pipelined)
+               finishPipeline();
+          throw;
+     }
+     if (pipelined)
+          finishPipeline();
+     std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+     report_simulation_time(elapsed.count());
+     if (skip > 0)
+          std::cerr << "Note: the trace ends " << skip << " accesses before the checkpoint's "
+                    << "offset; nothing was simulated." << std::endl;
+     if (!options.checkpoint_file.empty())
+          saveCheckpoint();
 
      calculate_miss_rates();
      memory_traffic = main_memory.reads + main_memory.writes;
 
-     print_contents();
+     if (time_parallel && options.validate)
+          validateAgainstSerial();
 
-     double L1MR = caches[L1].miss_rate;
-     double L2MR = caches[L2].miss_rate;
-     unsigned int L1Size = cache_sizes[L1];
-     unsigned int L2Size = cache_sizes[L2];
-     unsigned int ASSOC = cache_assocs[L1];
+     print_contents();
 }
 
-Block& MemArchitectureSim::read(unsigned int address)
+// Constructor for MemArchitectureSim over a shared, already loaded trace
+MemArchitectureSim::MemArchitectureSim(unsigned int blocksize,
+                                       const std::vector<unsigned int> &cache_sizes,
+                                       const std::vector<unsigned int> &cache_assocs,
+                                       unsigned int repl_policy, unsigned int incl_property,
+                                       std::span<const Instruction> trace, Cache &main_memory,
+                                       const SimOptions &options)
+
+    : blocksize(blocksize), cache_sizes(cache_sizes), cache_assocs(cache_assocs),
+      trace(trace), main_memory(main_memory), memory_traffic(0), debug(false),
+      options(options), numExecuted(0)
 {
-     auto hit = caches[L1].read(address);
+     inclusion_property = static_cast<InclusionProperty>(incl_property);
+     replacement_policy = static_cast<ReplacementPolicy>(repl_policy);
 
-     if (hit)
-     {
-          Block& block = *hit;
-          return block;
-     }
-     
-     // Allocate to cache on miss.
-     // caches[L1].allocate(address);
-}
+     numCaches = cache_sizes.size();
+     constructCaches();
 
-Block MemArchitectureSim::write(unsigned int address)
-{
-     caches[L1].write(address);
+     // The warmup prefix only fills the caches.
+     std::size_t warmup = std::min(options.warmup, trace.size());
+     executeChunk(trace.first(warmup));
+     for (auto &cache : caches)
+          cache.resetCounters();
+     this->main_memory.resetCounters();
+     executeChunk(trace.subspan(warmup));
+
+     calculate_miss_rates();
+     memory_traffic = this->main_memory.reads + this->main_memory.writes;
 }
 
-Block MemArchitectureSim::write_back(unsigned int address)
+void MemArchitectureSim::read(unsigned int address)
 {
+     // Misses are filled from the lower levels inside Cache::read.
+     caches[L1].read(address);
 }
 
-Block MemArchitectureSim::writeToCache(unsigned int cache_idx, unsigned int address)
+void MemArchitectureSim::write(unsigned int address)
 {
-
+     caches[L1].write(address);
 }
 
-std::optional<std::reference_wrapper<Block>> MemArchitectureSim::search(unsigned int address)
+std::optional<Block> MemArchitectureSim::search(unsigned int address)
 {
      for (auto& cache : caches)
      {
@@ -110,6 +272,14 @@ std::optional<std::reference_wrapper<Block>> MemArchitectureSim::search(unsigned
 
 void MemArchitectureSim::constructCaches()
 {
+     // Only the last level before main memory has a predictor.
+     std::size_t last_level = 0;
+     for (std::size_t i = 0; i < numCaches; i++)
+     {
+          if (cache_sizes[i] > 0)
+               last_level = i;
+     }
+
      numNonEmptyCaches = 0;
      for (std::size_t i = 0; i < numCaches; i++)
      {
@@ -123,8 +293,10 @@ void MemArchitectureSim::constructCaches()
                        blocksize,
                        cache_sizes[i], cache_assocs[i],
                        replacement_policy, inclusion_property,
-                       instructions,
-                       debug
+                       trace,
+                       debug,
+                       options.block_data,
+                       (i == last_level) ? options.predictor : InsertionPredictor::None
                     )
                );
           }
@@ -158,13 +330,281 @@ void MemArchitectureSim::calculate_miss_rates()
 void MemArchitectureSim::executeInstructions()
 {
      // if (VERBOSE) std::cout << "Executing instructions:" << std::endl;
-     for (auto instruction : instructions)
+     executeChunk(trace);
+}
+
+void MemArchitectureSim::executeChunk(std::span<const Instruction> chunk)
+{
+     // Accesses that a restored checkpoint already covers are passed over, once they are
+     // shown to be the ones it was taken on.
+     if (skip > 0)
+     {
+          std::size_t skipped = std::min(skip, chunk.size());
+          consume(chunk.first(skipped));
+          chunk = chunk.subspan(skipped);
+          skip -= skipped;
+          if (skip == 0 && consumed.value() != resume_checksum)
+               throw std::invalid_argument("checkpoint " + options.restore_file +
+                                           ": taken on a different trace");
+     }
+     consume(chunk);
+
+     for (const auto &instruction : chunk)
+     {
+          if (debug)
+               debugExecute(resume_offset + numExecuted, instruction);
+          else
+               execute(instruction);
+          numExecuted++;
+     }
+}
+
+void MemArchitectureSim::executePartitioned()
+{
+     // Each access to a set depends only on earlier accesses to that set. Split the sets into
+     // contiguous ranges, several per thread so stealing can even out hot ranges, and group
+     // the trace by range with one counting sort.
+     Cache &cache = caches[L1];
+     unsigned int numSets = cache.getNumSets();
+     std::size_t numRanges = std::min<std::size_t>(
+         numSets, static_cast<std::size_t>(options.set_threads) * RANGES_PER_THREAD);
+     const AddressDecoder &decoder = cache.getDecoder();
+     auto range_of = [&](const Instruction &instruction)
+     {
+          return static_cast<std::size_t>(decoder.setIndex(instruction.address)) * numRanges /
+                 numSets;
+     };
+
+     std::vector<std::size_t> offsets(numRanges + 1, 0);
+     for (const auto &instruction : trace)
+          offsets[range_of(instruction) + 1]++;
+     for (std::size_t r = 0; r < numRanges; r++)
+          offsets[r + 1] += offsets[r];
+
+     std::vector<Instruction> grouped(trace.size());
+     std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+     for (const auto &instruction : trace)
+          grouped[fill[range_of(instruction)]++] = instruction;
+
+     // Every range runs on its own copy of the hierarchy; the copies' sets and counters are
+     // merged back, so the result equals a serial run.
+     std::mutex merge_mutex;
+     WorkStealingPool pool(static_cast<unsigned int>(
+         std::min<std::size_t>(options.set_threads, numRanges)));
+     pool.run(numRanges, [&](std::size_t r)
+     {
+          std::span<const Instruction> accesses(grouped.data() + offsets[r],
+                                                offsets[r + 1] - offsets[r]);
+          unsigned int first_set = static_cast<unsigned int>((r * numSets + numRanges - 1) /
+                                                             numRanges);
+          unsigned int end_set = static_cast<unsigned int>(((r + 1) * numSets + numRanges - 1) /
+                                                           numRanges);
+
+          Cache memory(main_memory.name, blocksize, main_memory.getSize(),
+                       main_memory.getAssoc(), replacement_policy, inclusion_property,
+                       std::span<const Instruction>(), false);
+          Cache part(cache.name, blocksize, cache.getSize(), cache.getAssoc(),
+                     replacement_policy, inclusion_property, accesses, false,
+                     cache.storesData());
+          part.next_mem_level = &memory;
+
+          for (const auto &instruction : accesses)
+          {
+               if (instruction.op == MemoryAccess::Write)
+                    part.write(instruction.address);
+               else
+                    part.read(instruction.address);
+          }
+
+          std::lock_guard<std::mutex> lock(merge_mutex);
+          cache.mergeSets(part, first_set, end_set);
+          main_memory.mergeSets(memory, 0, 0);
+     });
+     numExecuted += trace.size();
+}
+
+void MemArchitectureSim::executeTimeParallel()
+{
+     // Chunk k covers [k * size / K, (k + 1) * size / K) and is warmed on up to
+     // options.warmup accesses just before it.
+     std::size_t numChunks = std::min<std::size_t>(options.time_chunks,
+                                                   std::max<std::size_t>(1, trace.size()));
+     std::mutex merge_mutex;
+     WorkStealingPool pool(static_cast<unsigned int>(numChunks));
+     pool.run(numChunks, [&](std::size_t k)
+     {
+          std::size_t begin = k * trace.size() / numChunks;
+          std::size_t end = (k + 1) * trace.size() / numChunks;
+          std::size_t warm_begin = begin - std::min(options.warmup, begin);
+
+          SimOptions part_options;
+          part_options.block_data = options.block_data;
+          part_options.warmup = begin - warm_begin;
+          part_options.predictor = options.predictor;
+          Cache memory(main_memory.name, blocksize, main_memory.getSize(),
+                       main_memory.getAssoc(), replacement_policy, inclusion_property,
+                       std::span<const Instruction>(), false);
+          MemArchitectureSim part(blocksize, cache_sizes, cache_assocs,
+                                  static_cast<unsigned int>(replacement_policy),
+                                  static_cast<unsigned int>(inclusion_property),
+                                  trace.subspan(warm_begin, end - warm_begin), memory,
+                                  part_options);
+
+          // Counters add up; the final contents are those of the last chunk.
+          std::lock_guard<std::mutex> lock(merge_mutex);
+          for (std::size_t i = 0; i < caches.size(); i++)
+               caches[i].mergeSets(part.caches[i], 0,
+                                   (k + 1 == numChunks) ? caches[i].getNumSets() : 0);
+          main_memory.mergeSets(part.main_memory, 0, 0);
+     });
+     numExecuted += trace.size();
+}
+
+// Rerun serially and report how far the time-parallel counts are from the exact ones.
+void MemArchitectureSim::validateAgainstSerial()
+{
+     Cache memory(main_memory.name, blocksize, main_memory.getSize(), main_memory.getAssoc(),
+                  replacement_policy, inclusion_property, std::span<const Instruction>(),
+                  false);
+     SimOptions serial_options;
+     serial_options.block_data = options.block_data;
+     serial_options.predictor = options.predictor;
+     MemArchitectureSim serial(blocksize, cache_sizes, cache_assocs,
+                               static_cast<unsigned int>(replacement_policy),
+                               static_cast<unsigned int>(inclusion_property), trace, memory,
+                               serial_options);
+
+     auto report = [](const std::string &name, const char *what, double parallel,
+                      double exact)
+     {
+          double error = parallel - exact;
+          std::cerr << std::setprecision(VALIDATE_DIGITS) << "Validate: " << name << " "
+                    << what << " " << parallel << " vs " << exact << " serial ("
+                    << std::showpos << error;
+          if (exact != 0.0)
+               std::cerr << ", " << std::setprecision(3) << 100.0 * error / exact << "%";
+          std::cerr << std::noshowpos << std::setprecision(6) << ")" << std::endl;
+     };
+     for (std::size_t i = 0; i < caches.size(); i++)
      {
-          execute(instruction);
+          const Cache &exact = serial.caches[i];
+          report(caches[i].name, "read misses", caches[i].read_misses, exact.read_misses);
+          report(caches[i].name, "write misses", caches[i].write_misses, exact.write_misses);
+          report(caches[i].name, "writebacks", caches[i].write_backs, exact.write_backs);
+          report(caches[i].name, "miss rate", caches[i].miss_rate, exact.miss_rate);
      }
+     report("memory", "traffic", main_memory.numAccesses, serial.main_memory.numAccesses);
 }
 
-void MemArchitectureSim::execute(Instruction &instruction)
+// Every cache, then main memory: the sections of a checkpoint.
+std::vector<Cache *> MemArchitectureSim::levels()
+{
+     std::vector<Cache *> levels;
+     for (auto &cache : caches)
+          levels.push_back(&cache);
+     levels.push_back(&main_memory);
+     return levels;
+}
+
+// Adds accesses passed over or simulated, in trace order, to the checksum of the trace so far.
+void MemArchitectureSim::consume(std::span<const Instruction> instructions)
+{
+     consumed.update(instructions.data(), instructions.size_bytes());
+     numConsumed += instructions.size();
+}
+
+void MemArchitectureSim::saveCheckpoint()
+{
+     std::size_t offset = resume_offset + numExecuted;
+     // Set- and time-parallel runs read the loaded trace without going through executeChunk.
+     if (numConsumed < offset)
+          consume(trace.subspan(numConsumed, offset - numConsumed));
+     std::vector<Cache *> sections = levels();
+     if (!save_checkpoint(options.checkpoint_file, blocksize, replacement_policy,
+                          inclusion_property, options.predictor, {offset, consumed.value()},
+                          std::span<const Cache *const>(sections.data(), sections.size())))
+     {
+          std::cerr << "Error: Unable to write checkpoint: " << options.checkpoint_file
+                    << std::endl;
+          return;
+     }
+     std::cerr << "Checkpoint: state after " << offset << " accesses saved to "
+               << options.checkpoint_file << std::endl;
+}
+
+void MemArchitectureSim::restoreCheckpoint()
+{
+     std::vector<Cache *> sections = levels();
+     CheckpointPosition position = restore_checkpoint(options.restore_file, blocksize,
+                                                      replacement_policy, inclusion_property,
+                                                      options.predictor, sections);
+     resume_offset = position.trace_offset;
+     resume_checksum = position.trace_checksum;
+     skip = resume_offset;
+     std::cerr << "Checkpoint: resuming " << options.restore_file << " after "
+               << resume_offset << " accesses" << std::endl;
+     // Blocks are looked up again in this trace, but the victims chosen before the checkpoint
+     // could only look ahead as far as the trace it was taken on.
+     if (replacement_policy == ReplacementPolicy::Optimal)
+          std::cerr << "Note: optimal victims before the checkpoint looked ahead only to its "
+                    << "offset; counts can differ from a serial run." << std::endl;
+}
+
+void MemArchitectureSim::startPipeline(bool recording)
+{
+     if (recording)
+     {
+          recorder = std::make_unique<BinaryTraceWriter>(options.record_file,
+                                                         TraceEncoding::Delta);
+          if (!recorder->is_open())
+          {
+               std::cerr << "Error: Unable to create request file: " << options.record_file
+                         << std::endl;
+               recorder.reset();
+          }
+     }
+
+     pipe = std::make_unique<RequestPipe>();
+     Cache &first = caches[L1];
+     first.downstream = pipe.get();
+     lower_levels = std::thread([this, &first]
+     {
+          Cache &next = *first.next_mem_level;
+          pipe->drain([&](std::span<const Instruction> batch)
+          {
+               if (recorder)
+                    recorder->write(batch);
+               for (const auto &request : batch)
+               {
+                    if (request.op == MemoryAccess::Write)
+                         next.write(request.address);
+                    else
+                         next.read(request.address);
+               }
+          });
+     });
+}
+
+void MemArchitectureSim::finishPipeline()
+{
+     pipe->close();
+     lower_levels.join();
+     caches[L1].downstream = NULL;
+     pipe.reset();
+
+     if (!recorder)
+          return;
+     if (!recorder->close())
+          std::cerr << "Error: Failed writing request file: " << options.record_file << std::endl;
+     else
+          std::cerr << "Recorded " << recorder->getCount() << " " << caches[L1].name
+                    << " requests for " << numExecuted << " accesses in "
+                    << sizeof(BinaryTraceHeader) + recorder->getPayloadBytes() << " bytes: "
+                    << options.record_file << std::endl;
+     recorder.reset();
+}
+
+void MemArchitectureSim::execute(const Instruction &instruction)
 {
      MemoryAccess operation = static_cast<MemoryAccess>(instruction.op);
      unsigned int address = instruction.address;
@@ -175,62 +615,121 @@ void MemArchitectureSim::execute(Instruction &instruction)
      }
 }
 
-void MemArchitectureSim::readInstructions()
+void MemArchitectureSim::streamInstructions()
 {
-     std::ifstream file(trace_file);
+     if (detect_trace_format(trace_file) == TraceFormat::Binary)
+     {
+          streamBinaryInstructions();
+          return;
+     }
 
-     if (!file.is_open())
+     TraceStream stream(trace_file);
+
+     if (!stream.is_open())
      {
           std::cerr << "Error: Unable to open trace file: " << trace_file << std::endl;
           return;
      }
 
-     // Read in all lines from file.
-     std::string line;
-     while (std::getline(file, line))
+     // Execute each chunk while the parser thread fills the next one.
+     if (debug)
+          std::cout << "----------------------------------------" << std::endl;
+
+     stream.start();
+     while (auto chunk = stream.next())
      {
-          std::istringstream input_stream(line);
-          std::string instruction_str;
-          std::string address_str;
+          executeChunk(*chunk);
+          stream.release(chunk);
+     }
 
-          // Read the instruction and address from the line.
-          if (!(input_stream >> instruction_str >> address_str))
-          {
-               std::cerr << "Error: Invalid line format: " << line << std::endl;
-               continue; // Skip to the next line
-          }
+     trace_stats = stream.getStats();
+     trace_stats.report(std::cerr);
+}
 
-          // Convert instruction_str to MemoryAccess enum
-          MemoryAccess access;
-          if (instruction_str == "r") { access = MemoryAccess::Read; }
-          else if (instruction_str == "w") { access = MemoryAccess::Write; }
-          else
-          {
-               std::cerr << "Error: Unknown instruction type: " << instruction_str 
-               << std::endl;
-               continue; // Skip to the next line
-          }
+void MemArchitectureSim::streamBinaryInstructions()
+{
+     if (!openBinaryTrace())
+          return;
 
-          // Convert the address string to an unsigned int
-          unsigned int address;
-          try { address = std::stoul(address_str, nullptr, HEX); }
-          catch (const std::invalid_argument &e)
-          {
-               std::cerr << "Error: Invalid address format: " << address_str << std::endl;
-               continue; // Skip to the next line
-          }
+     if (debug)
+          std::cout << "----------------------------------------" << std::endl;
 
-          // Create an Instruction object and store it
-          instructions.emplace_back(static_cast<unsigned short>(access), address);
+     // Raw records are executed straight from the mapping.
+     if (binary_trace.getEncoding() == TraceEncoding::Raw)
+     {
+          executeChunk(binary_trace.records());
+          return;
      }
 
-     file.close(); // Close the file after reading
+     // Delta payloads are decoded into one reusable chunk at a time.
+     std::vector<Instruction> chunk;
+     chunk.reserve(BINARY_CHUNK);
+     for (;;)
+     {
+          chunk.clear();
+          auto start = std::chrono::steady_clock::now();
+          std::size_t decoded = binary_trace.decode(chunk, BINARY_CHUNK);
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+          trace_stats.seconds += elapsed.count();
+
+          if (decoded == 0) break;
+          executeChunk(chunk);
+     }
+}
+
+bool MemArchitectureSim::openBinaryTrace()
+{
+     std::string error;
+     if (!binary_trace.open(trace_file, error))
+     {
+          std::cerr << "Error: " << trace_file << ": " << error << std::endl;
+          return false;
+     }
+
+     auto start = std::chrono::steady_clock::now();
+     if (!binary_trace.verify())
+     {
+          std::cerr << "Error: " << trace_file << ": checksum mismatch" << std::endl;
+          return false;
+     }
+     std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+     trace_stats = TraceStats();
+     trace_stats.bytes = binary_trace.getFileSize();
+     trace_stats.lines = binary_trace.getCount();
+     trace_stats.accesses = binary_trace.getCount();
+     trace_stats.seconds = elapsed.count();
+     return true;
+}
+
+void MemArchitectureSim::readInstructions()
+{
+     if (!loaded.load(trace_file, options.parse_threads))
+          return;
+
+     trace = loaded.instructions();
+     trace_stats = loaded.getStats();
+     trace_stats.report(std::cerr);
+}
+
+void MemArchitectureSim::report_simulation_time(double seconds)
+{
+     // Stated in trace MB/s as well so it can be compared directly with the parse phase.
+     double megabytes = trace_stats.bytes / BYTES_PER_MB;
+     double mb_per_second = (seconds > 0.0) ? megabytes / seconds : 0.0;
+     double accesses_per_second = (seconds > 0.0) ? numExecuted / seconds : 0.0;
+
+     std::cerr << "Simulate: " << numExecuted << " accesses in " << std::fixed
+               << std::setprecision(3) << seconds << " s (" << std::setprecision(1)
+               << mb_per_second << " MB/s, " << std::setprecision(0) << accesses_per_second
+               << " accesses/s)" << std::endl;
+     std::cerr << std::defaultfloat;
 }
 
 void MemArchitectureSim::printInstructions()
 {
      std::string instruction_str;
-     for (const auto &instruction : instructions)
+     for (const auto &instruction : trace)
      {
           instruction_str = (instruction.op == MemoryAccess::Write) ? "Write" : "Read";
 
@@ -254,7 +753,7 @@ void MemArchitectureSim::print_contents()
 {
      for (int i = 0; i < numCaches; i++)
      {
-          std::cout << "===== L" << std::to_string(i+1) << " contents =====" << std::endl;
+          std::cout << "===== " << caches[i].name << " contents =====" << std::endl;
           caches[i].print_contents();
      }
 
@@ -264,6 +763,7 @@ void MemArchitectureSim::print_contents()
      std::string reads, read_misses, writes, write_misses, miss_rate, writebacks;
      std::string memory_traffic{};
      unsigned int originalNumCaches = cache_sizes.size();
+     std::size_t level = 0; // Index into `caches`, which skips absent levels
      for (std::size_t i = 0; i < originalNumCaches; i++)
      {
           std::string name = "L" + std::to_string(i + 1); // (i.g. "L1")
@@ -276,23 +776,25 @@ void MemArchitectureSim::print_contents()
 
           if (cache_sizes[i] > 0)
           {
+               const Cache &cache = caches[level++];
+
                out(reads);
-               std::cout << std::to_string(caches[i].reads) << std::endl;
+               std::cout << std::to_string(cache.reads) << std::endl;
 
                out(read_misses);
-               std::cout << std::to_string(caches[i].read_misses) << std::endl;
+               std::cout << std::to_string(cache.read_misses) << std::endl;
 
                out(writes);
-               std::cout << std::to_string(caches[i].writes) << std::endl;
+               std::cout << std::to_string(cache.writes) << std::endl;
 
                out(write_misses);
-               std::cout << std::to_string(caches[i].write_misses) << std::endl;
+               std::cout << std::to_string(cache.write_misses) << std::endl;
 
                out(miss_rate);
-               std::cout << std::to_string(caches[i].miss_rate) << std::endl;
+               std::cout << std::to_string(cache.miss_rate) << std::endl;
 
                out(writebacks);
-               std::cout << std::to_string(caches[i].write_backs) << std::endl;
+               std::cout << std::to_string(cache.write_backs) << std::endl;
           }
           else
           {
@@ -318,26 +820,43 @@ void MemArchitectureSim::print_contents()
      memory_traffic = std::string(1, label++) + ". total memory traffic:";
      out(memory_traffic);
      std::cout << std::to_string(main_memory.numAccesses) << std::endl;
+
+     // The last level's predictor, if it has one.
+     const HitPredictor &predictor = caches.back().getPredictor();
+     if (!predictor.enabled())
+          return;
+     const HitPredictor::Counters &counts = predictor.getCounters();
+     std::string name = caches.back().name;
+     auto counter = [&](const std::string &what, std::uint64_t value)
+     {
+          out(std::string(1, label++) + ". " + name + " " + what + ":");
+          std::cout << std::to_string(value) << std::endl;
+     };
+     counter("dead-predicted fills", counts.dead_fills);
+     counter("live-predicted fills", counts.live_fills);
+     counter("bypasses", counts.bypasses);
+     counter("dead evicted unused", counts.dead_unused);
+     counter("dead evicted reused", counts.dead_reused);
+     counter("live evicted reused", counts.live_reused);
+     counter("live evicted unused", counts.live_unused);
+     out(std::string(1, label++) + ". " + name + " predictor accuracy:");
+     std::cout << std::to_string(predictor.accuracy()) << std::endl;
 }
 
 void MemArchitectureSim::print_debug()
+{
+     std::cout << "----------------------------------------" << std::endl;
+
+     executeChunk(trace);
+}
+
+void MemArchitectureSim::debugExecute(std::size_t i, const Instruction &instruction)
 {
      using std::cout;
      using std::endl;
-     using std::setw;
-     using std::left;
 
+     cout << "# " << std::to_string(i + 1) << " : ";
+     cout << instruction.to_string() << endl;
+     execute(instruction);
      cout << "----------------------------------------" << endl;
-
-     int numInstructions = instructions.size();
-     int i;
-     for (i = 0; i < numInstructions; i++)
-     {
-          cout << "# " << std::to_string(i + 1) << " : ";
-          cout << instructions[i].to_string() << endl;
-          execute(instructions[i]);
-          cout << "----------------------------------------" << endl;
-
-          // if (i + 1 >= LAST_INSTRUCTION) break;
-     }
 }
@@ -4,13 +4,37 @@
 #include <memory>
 #include <optional>
 #include <functional>
+#include <span>      // for std::span
 #include <vector>    // for std::vector
 #include <string>    // for std::string
+#include <thread>    // for std::thread
 
+#include "binary_trace.hpp"
 #include "block.hpp"
 #include "cache.hpp"
+#include "insertion_predictor.hpp"
 #include "instruction.hpp"
+#include "loaded_trace.hpp"
 #include "output.hpp"
+#include "request_pipe.hpp"
+#include "trace_parser.hpp"
+
+// Optional execution modes selected on the command line.
+struct SimOptions
+{
+     bool stream = false;           // Parse and execute in bounded chunks (LRU/FIFO only)
+     unsigned int parse_threads = 1; // Threads used to parse a text trace
+     bool block_data = false;       // Back block payloads with a per-cache arena
+     unsigned int set_threads = 1;  // Threads simulating disjoint set ranges (single level)
+     bool pipeline = false;         // Simulate the levels below L1 on their own thread
+     std::string record_file;       // Save L1's requests to the next level as a binary trace
+     unsigned int time_chunks = 1;  // Contiguous trace slices simulated at once (approximate)
+     std::size_t warmup = 0;        // Accesses that warm each slice, uncounted
+     bool validate = false;         // Compare time-parallel counts with a serial run
+     std::string checkpoint_file;   // Save the whole hierarchy here after the run
+     std::string restore_file;      // Resume from this checkpoint, skipping what it covers
+     InsertionPredictor predictor = InsertionPredictor::None; // At the last-level cache
+};
 
 class MemArchitectureSim
 {
@@ -21,20 +45,35 @@ public:
                         const std::vector<unsigned int> &cache_assocs, 
                         unsigned int repl_policy, unsigned int incl_property, 
                         const std::string &trace_file,
-                        Cache &main_memory, bool debug);
+                        Cache &main_memory, bool debug,
+                        const SimOptions &options = SimOptions());
+
+     // Simulates a trace the caller already loaded, printing nothing. The trace is only read,
+     // so many simulators can share one. Results are left in the caches for the getters.
+     // The first options.warmup accesses only fill the caches.
+     MemArchitectureSim(unsigned int blocksize,
+                        const std::vector<unsigned int> &cache_sizes,
+                        const std::vector<unsigned int> &cache_assocs,
+                        unsigned int repl_policy, unsigned int incl_property,
+                        std::span<const Instruction> trace,
+                        Cache &main_memory,
+                        const SimOptions &options = SimOptions());
 
      void constructCaches();
      void addCache(const Cache &cache);
      void readInstructions();
+     void streamInstructions();
      void printInstructions();
      void executeInstructions();
-     void execute(Instruction &instruction);
+     void executeChunk(std::span<const Instruction> chunk);
+     void executePartitioned();
+     void executeTimeParallel();
+     void execute(const Instruction &instruction);
 
-     Block& read(unsigned int address);
-     Block write(unsigned int address);
-     Block write_back(unsigned int address);
+     void read(unsigned int address);
+     void write(unsigned int address);
 
-     std::optional<std::reference_wrapper<Block>> search(unsigned int addr);
+     std::optional<Block> search(unsigned int addr);
 
      // Getters
      unsigned int getBlocksize() const { return blocksize; }
@@ -42,30 +81,56 @@ public:
      ReplacementPolicy getReplacementPolicy() const { return replacement_policy; }
      InclusionProperty getInclusionProperty() const { return inclusion_property; }
      std::string  getTraceFile() const { return trace_file; }
+     const std::vector<Cache> &getCaches() const { return caches; } // Non-empty levels only
+     unsigned int getMemoryTraffic() const { return main_memory.numAccesses; }
 
      void print_contents();
      void print_debug();
+     void debugExecute(std::size_t i, const Instruction &instruction);
 
 private:
-     Block writeToCache(unsigned int cache_idx, unsigned int address);
      void calculate_miss_rates();
+     bool openBinaryTrace();
+     void streamBinaryInstructions();
+     void report_simulation_time(double seconds);
+     void startPipeline(bool recording);
+     void finishPipeline();
+     void validateAgainstSerial();
+     std::vector<Cache *> levels();
+     void saveCheckpoint();
+     void restoreCheckpoint();
+     void consume(std::span<const Instruction> instructions);
 
      bool debug;
+     SimOptions options;
 
      unsigned int blocksize;
      ReplacementPolicy replacement_policy;
      InclusionProperty inclusion_property;
      std::string trace_file;
-     std::vector<Instruction> instructions;
+     LoadedTrace loaded;                 // The whole trace, unless streaming or shared
+     std::span<const Instruction> trace; // What is simulated
+     BinaryTrace binary_trace;           // Streamed binary traces
+     TraceStats trace_stats;
+     std::size_t numExecuted;       // Accesses simulated by this run
+     std::size_t resume_offset = 0; // Accesses covered by the restored checkpoint
+     std::size_t skip = 0;          // Of those, the ones not yet passed over
+     std::uint64_t resume_checksum = 0; // TraceChecksum of the accesses it covers
+     TraceChecksum consumed;        // Of the accesses passed over or simulated so far
+     std::size_t numConsumed = 0;
      std::size_t numCaches;
      std::size_t numNonEmptyCaches;
      std::vector<Cache> caches;
      Cache main_memory;
      unsigned int memory_traffic;
-     const std::vector<unsigned int> &cache_assocs;
-     const std::vector<unsigned int> &cache_sizes;
+     std::vector<unsigned int> cache_assocs;
+     std::vector<unsigned int> cache_sizes;
 
      std::vector<Output>outputs;
+
+     std::unique_ptr<RequestPipe> pipe; // L1 to L2, while pipelined
+     std::thread lower_levels;          // Consumes `pipe`
+     std::unique_ptr<BinaryTraceWriter> recorder; // Copies `pipe` to options.record_file
 };
 
 #endif // MEM_ARCHITECTURE_SIM_HPP
\ No newline at end of file
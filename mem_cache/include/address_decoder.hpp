@@ -0,0 +1,45 @@
+#ifndef ADDRESS_DECODER_HPP
+#define ADDRESS_DECODER_HPP
+
+// Splits 32-bit addresses into tag, set index and block offset for one cache geometry.
+// Shift amounts and masks are computed once, so decoding is a shift and a mask.
+//
+//   | tag | set index | block offset |
+//         ^ tagShift  ^ offsetLength
+class AddressDecoder
+{
+public:
+     AddressDecoder() = default;
+
+     // Throws std::invalid_argument unless the block size and, when `validate_sets` is set,
+     // the number of sets are powers of two.
+     AddressDecoder(unsigned int blocksize, unsigned int numSets, bool validate_sets = true);
+
+     unsigned int setIndex(unsigned int address) const
+     {
+          return (address >> offsetLength) & indexMask;
+     }
+
+     unsigned int tag(unsigned int address) const { return address >> tagShift; }
+
+     // Address with the block offset bits cleared.
+     unsigned int blockPrefix(unsigned int address) const { return address & ~offsetMask; }
+
+     // Inverse of tag() and setIndex(): the first address of the block.
+     unsigned int blockAddress(unsigned int tag, unsigned int setIndex) const
+     {
+          return (tag << tagShift) | (setIndex << offsetLength);
+     }
+
+     // Getters
+     unsigned int getOffsetLength() const { return offsetLength; }
+     unsigned int getIndexLength() const { return tagShift - offsetLength; }
+
+private:
+     unsigned int offsetLength = 0;
+     unsigned int tagShift = 0;
+     unsigned int offsetMask = 0;
+     unsigned int indexMask = 0;
+};
+
+#endif // ADDRESS_DECODER_HPP
@@ -1,33 +1,17 @@
 #ifndef BLOCK_HPP
 #define BLOCK_HPP
 
-#include <cstddef> // for std::size_t
-#include <vector>  // for std::vector
-
-#include "address.hpp"
-
+// Metadata of one cache way. Payload bytes, when simulated at all, live in the owning
+// cache's BlockData arena, so blocks are cheap to copy on every fill and eviction.
 class Block
 {
      
 public:
      // Constructors
-     Block(std::size_t blocksize, const Address &addr);
-     Block(std::size_t blocksize, const Address &addr, const unsigned char *inputData);
-
-     // Destructor to clean up any resources
-     ~Block();
-
-     // Copy assignment operator
-     Block &operator=(const Block &other);
-
-     // Method to write a byte to the data array at a specific index
-     void writeByte(std::size_t index, unsigned char value);
+     explicit Block(unsigned int tag);
 
-     // Method to read a byte from the data array at a specific index
-     unsigned char readByte(std::size_t index) const;
-
-     bool isDirty() { return dirtyBit == true; }
-     bool isAvailable() { return empty == true; }
+     bool isDirty() const { return dirtyBit == true; }
+     bool isAvailable() const { return empty == true; }
 
      // Setters
      void setDirty() { dirtyBit = true; }
@@ -36,15 +20,21 @@ public:
      void occupy() { empty = false; }
 
      // Getters
-     std::size_t getBlockSize() const { return blocksize; }
-     const Address &getAddress() const { return address; }
+     unsigned int getTag() const { return tag; }
 
 private:
      bool empty;
-     std::size_t blocksize; // Size of the block in bytes
-     Address address;
-     unsigned char *data; // Pointer to the data array (each cell stores a byte)
+     unsigned int tag; // The owning set's decoder rebuilds the block address from it
      bool dirtyBit = false;
 };
 
+// A block displaced by a fill: the tag and state it held and the way it was evicted from.
+// Returned by value, so evictions need no allocation. The owning cache knows the set.
+struct Victim
+{
+     unsigned int tag;
+     unsigned int way;
+     bool dirty;
+};
+
 #endif // BLOCK_HPP
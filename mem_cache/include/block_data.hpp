@@ -0,0 +1,40 @@
+#ifndef BLOCK_DATA_HPP
+#define BLOCK_DATA_HPP
+
+#include <cstddef> // for std::size_t
+#include <span>    // for std::span
+#include <vector>  // for std::vector
+
+// Payload bytes for every way of one cache, in a single allocation owned by the cache.
+// Way `way` of set `setIndex` owns the `blocksize` bytes at (setIndex * assoc + way) * blocksize.
+// A default-constructed arena is empty, which is the tag-only mode.
+class BlockData
+{
+public:
+     BlockData() = default;
+     BlockData(unsigned int numSets, unsigned int assoc, unsigned int blocksize);
+
+     bool enabled() const { return !bytes.empty(); }
+
+     std::span<unsigned char> line(unsigned int setIndex, unsigned int way);
+     std::span<const unsigned char> line(unsigned int setIndex, unsigned int way) const;
+
+     // Zero a way's payload when it receives a new block.
+     void clear(unsigned int setIndex, unsigned int way);
+
+     // Overwrite the payloads of sets [first, end) with those of `other`, of the same shape.
+     void copySets(const BlockData &other, unsigned int first, unsigned int end);
+
+     // Every payload byte, for checkpoints.
+     std::span<unsigned char> raw() { return bytes; }
+     std::span<const unsigned char> raw() const { return bytes; }
+
+private:
+     std::size_t offset(unsigned int setIndex, unsigned int way) const;
+
+     unsigned int assoc = 0;
+     unsigned int blocksize = 0;
+     std::vector<unsigned char> bytes;
+};
+
+#endif // BLOCK_DATA_HPP
@@ -5,15 +5,25 @@
 #include <string>
 #include <functional>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "output.hpp"
 #include "inclusion_property.hpp"
+#include "insertion_predictor.hpp"
 #include "replacement_policy.hpp"
-#include "address.hpp"
+#include "address_decoder.hpp"
 #include "block.hpp"
+#include "block_data.hpp"
+#include "cache_slab.hpp"
+#include "fully_associative_index.hpp"
+#include "hit_predictor.hpp"
 #include "instruction.hpp"
+#include "request_pipe.hpp"
 #include "set.hpp"
+#include "set_dueling.hpp"
+#include "set_policy.hpp"
+#include "set_trace.hpp"
 
 class Cache
 {
@@ -22,21 +32,47 @@ public:
      Cache(const std::string name, unsigned int blocksize, unsigned int size, 
            unsigned int assoc,
            ReplacementPolicy replacement_policy, InclusionProperty inclusion_property,
-           std::vector<Instruction> &instructions, bool debug);
+           std::span<const Instruction> instructions, bool debug, bool store_data = false,
+           InsertionPredictor insertion_predictor = InsertionPredictor::None);
 
-     std::optional<std::reference_wrapper<Block>> read(unsigned int addr);
-     std::optional<std::reference_wrapper<Block>> write(unsigned int addr);
-     std::optional<std::reference_wrapper<Block>> search(unsigned int addr);
-     std::optional<std::reference_wrapper<Block>> load(unsigned int addr);
+     // Accesses run the path compiled for this cache's policy and associativity.
+     std::optional<Block> read(unsigned int addr) { return (this->*engine.read)(addr); }
+     std::optional<Victim> write(unsigned int addr) { return (this->*engine.write)(addr); }
+     std::optional<Block> search(unsigned int addr);
+     std::optional<Block> load(unsigned int addr);
 
-     std::optional<std::reference_wrapper<Block>> allocate(unsigned int addr);
+     std::optional<Victim> allocate(unsigned int addr) { return (this->*engine.allocate)(addr); }
 
      void delete_block(unsigned int addr);
 
+     // Take sets [first_set, end_set) from `other` and add its counters to these. `other` has
+     // the same geometry and has simulated only accesses to those sets, so its other sets are
+     // empty. An empty range merges just the counters.
+     void mergeSets(const Cache &other, unsigned int first_set, unsigned int end_set);
+
+     // Re-derive the lookup index of a fully associative cache after its slab was overwritten
+     // in place, as by a checkpoint restore.
+     void rebuildIndex();
+
+     // Look up again where each block of an optimal cache is next used, after its slab was
+     // overwritten in place. The saved positions were found in the trace the slab was taken
+     // on, which may have been only a prefix of this cache's trace.
+     void restampNextUses();
+
+     // Payload access for a resident block, only in data mode. Throw std::logic_error in
+     // tag-only mode and std::out_of_range if the block is absent or `index` is past its end.
+     unsigned char readByte(unsigned int addr, std::size_t index) const;
+     void writeByte(unsigned int addr, std::size_t index, unsigned char value);
+
      // Setters
      void access() { numAccesses++; }
+     void resetCounters();
      double calculate_miss_rate();
 
+     // The miss rate reported for a cache with these counts.
+     static double miss_rate_of(unsigned int reads, unsigned int read_misses,
+                                unsigned int writes, unsigned int write_misses);
+
      // Getters
      unsigned int getAssoc() const { return assoc; }
      unsigned int getBlocksize() const { return blocksize; }
@@ -45,14 +81,22 @@ public:
      unsigned int getNumAccesses() const { return numAccesses; }
      ReplacementPolicy getReplacementPolicy() const { return replacement_policy; }
      InclusionProperty getInclusionProperty() const { return inclusion_property; }
-     const std::vector<Set> &getCache() const { return cache; }
-
-     void update_optimal(unsigned int addr);
+     const CacheSlab &getSlab() const { return slab; }
+     CacheSlab &getSlab() { return slab; }
+     const BlockData &getData() const { return data; }
+     BlockData &getData() { return data; }
+     const AddressDecoder &getDecoder() const { return decoder; }
+     bool storesData() const { return data.enabled(); }
+     const SetDueling &getDueling() const { return dueling; }
+     SetDueling &getDueling() { return dueling; }
+     const HitPredictor &getPredictor() const { return predictor; }
+     HitPredictor &getPredictor() { return predictor; }
 
      void print_contents();
 
      Cache *prev_mem_level = NULL;
      Cache *next_mem_level = NULL;
+     RequestPipe *downstream = NULL; // If set, requests to next_mem_level are queued here
      const std::string name;
 
      unsigned int reads;
@@ -64,26 +108,73 @@ public:
      unsigned int numAccesses;
 
 private :
-     void construct_set_traces(std::vector<Instruction> &instructions);
-     void address_output(const Address &address);
-     void block_output(Block &block);
-     void op_output(std::string op, unsigned int addr);
+     // Read, write and allocate as compiled for one policy and associativity. Chosen once at
+     // construction, so nothing on the access path switches on the configuration.
+     struct Engine
+     {
+          std::optional<Block> (Cache::*read)(unsigned int addr);
+          std::optional<Victim> (Cache::*write)(unsigned int addr);
+          std::optional<Victim> (Cache::*allocate)(unsigned int addr);
+     };
+
+     static Engine select_engine(ReplacementPolicy replacement_policy, unsigned int assoc,
+                                 bool indexed, bool main_memory);
+     template <SetPolicy Policy>
+     static Engine engine_for(unsigned int assoc, bool indexed);
+     template <SetPolicy Policy, unsigned int Ways>
+     static Engine engine_of();
+
+     template <SetPolicy Policy, unsigned int Ways>
+     std::optional<Block> read_as(unsigned int addr);
+     template <SetPolicy Policy, unsigned int Ways>
+     std::optional<Victim> write_as(unsigned int addr);
+     template <SetPolicy Policy, unsigned int Ways>
+     std::optional<Victim> allocate_as(unsigned int addr);
+     template <SetPolicy Policy, unsigned int Ways>
+     Set set_as(unsigned int setIndex);
+     template <SetPolicy Policy, unsigned int Ways>
+     void predict_fill(Set &set, unsigned int setIndex, unsigned int addr,
+                       const std::optional<Victim> &victim);
+
+     // Main memory only counts accesses.
+     std::optional<Block> read_main_memory(unsigned int addr);
+     std::optional<Victim> write_main_memory(unsigned int addr);
+     std::optional<Victim> allocate_main_memory(unsigned int addr);
+
+     void construct_set_traces(std::span<const Instruction> instructions);
+     std::optional<Block> next_read(unsigned int addr);
+     void next_write(unsigned int addr);
+     Set set_at(unsigned int setIndex) const;
+     unsigned int resident_way(unsigned int addr) const;
+     std::size_t checked_offset(std::size_t index) const;
+     void clear_data(unsigned int setIndex, unsigned int tag);
+     void address_output(unsigned int addr);
+     void block_output(const Victim &victim, unsigned int setIndex);
+     void op_output(const char *op, unsigned int addr);
      void hit_output();
      void miss_output();
-     void victim_output(Block &block);
+     void bypass_output();
+     void victim_output(const Victim &victim, unsigned int setIndex);
      void no_victim_output();
 
      bool debug;
+     bool main_memory;
 
      unsigned int assoc;
      unsigned int blocksize;
      unsigned int size;
      unsigned int numSets;
+     AddressDecoder decoder;
 
      ReplacementPolicy replacement_policy;
      InclusionProperty inclusion_property;
-     std::vector<Instruction> instructions;
-     std::vector<Set> cache;
+     CacheSlab slab; // Tags, state and replacement metadata of every set
+     SetTraces set_traces; // Accesses grouped by set, for optimal only
+     BlockData data; // Empty unless the cache was built to store payloads
+     FullyAssociativeIndex fa_index; // Empty unless the cache is one wide set
+     SetDueling dueling; // SRRIP against BRRIP insertion, for DRRIP only
+     HitPredictor predictor; // Empty unless built as a last level with a predictor
+     Engine engine;
 };
 
 #endif // CACHE_HPP
@@ -0,0 +1,68 @@
+#ifndef CACHE_SLAB_HPP
+#define CACHE_SLAB_HPP
+
+#include <cstddef> // for std::size_t, std::byte
+#include <memory>  // for std::unique_ptr
+#include <optional> // for std::optional
+#include <span>    // for std::span
+#include <string>  // for std::string
+
+#include "fully_associative_index.hpp"
+#include "replacement_policy.hpp"
+#include "set_dueling.hpp"
+#include "set.hpp"
+
+// Metadata of every set of one cache in a single allocation aligned to host cache lines.
+// Set `s` owns the fixed-size record at s * layout.stride, laid out as
+//
+//   | SetState | valid bits | dirty bits | tags | LRU counters | FIFO ring | next uses | RRPVs |
+//
+// so one lookup reads the state, masks and tags of an 8- or 16-way set from one or two lines.
+// Sets of up to 16 ways keep LRU order packed in their SetState and have no LRU counters.
+// Records start zeroed, which is an empty set whose ways all hold tag 0.
+class CacheSlab
+{
+public:
+     CacheSlab() = default;
+     CacheSlab(unsigned int numSets, unsigned int assoc, ReplacementPolicy replacement_policy,
+               const std::string &cache_name, bool debug);
+
+     CacheSlab(const CacheSlab &other);
+     CacheSlab &operator=(const CacheSlab &other);
+     CacheSlab(CacheSlab &&other) noexcept = default;
+     CacheSlab &operator=(CacheSlab &&other) noexcept = default;
+
+     // View of set `setIndex`, looking ahead in `trace` for optimal replacement, looking
+     // tags up in `index` if the set is accessed as INDEXED_WAYS, and dueling in `dueling`
+     // for DRRIP.
+     Set set(unsigned int setIndex, std::optional<SetTrace> trace = std::nullopt,
+             FullyAssociativeIndex *index = nullptr, SetDueling *dueling = nullptr) const
+     {
+          return Set(layout, bytes.get() + setIndex * layout.stride, setIndex, trace, index,
+                     dueling);
+     }
+
+     // Overwrite sets [first, end) with those of `other`, which must have the same layout.
+     void copySets(const CacheSlab &other, unsigned int first, unsigned int end);
+
+     // Every set record, for checkpoints. Records hold no pointers, so they can be saved and
+     // restored byte for byte into a slab of the same layout.
+     std::span<std::byte> raw() { return {bytes.get(), getBytes()}; }
+     std::span<const std::byte> raw() const { return {bytes.get(), getBytes()}; }
+
+     unsigned int getNumSets() const { return numSets; }
+     std::size_t getStride() const { return layout.stride; }
+     std::size_t getBytes() const { return numSets * layout.stride; }
+
+private:
+     struct AlignedDelete
+     {
+          void operator()(std::byte *bytes) const;
+     };
+
+     unsigned int numSets = 0;
+     SetLayout layout{};
+     std::unique_ptr<std::byte[], AlignedDelete> bytes;
+};
+
+#endif // CACHE_SLAB_HPP
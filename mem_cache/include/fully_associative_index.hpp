@@ -0,0 +1,86 @@
+#ifndef FULLY_ASSOCIATIVE_INDEX_HPP
+#define FULLY_ASSOCIATIVE_INDEX_HPP
+
+#include <climits> // for UINT_MAX
+#include <vector>  // for std::vector
+
+// Lookup structures for a cache with a single set of many ways, so that a lookup and an LRU
+// eviction cost the same at 8192 ways as at 8. Tags of valid ways are kept in an
+// open-addressing hash table with linear probing, and the ways in an intrusive doubly linked
+// list from least to most recently used. Both mirror the set's record, which stays the state
+// that is printed and checkpointed, and can be rebuilt from it.
+class FullyAssociativeIndex
+{
+public:
+     static constexpr unsigned int NONE = UINT_MAX;
+
+     FullyAssociativeIndex() = default;
+     explicit FullyAssociativeIndex(unsigned int ways);
+
+     bool enabled() const { return !links.empty(); }
+
+     // Forget every way.
+     void clear();
+
+     // Way holding `tag`, or `ways` if no valid way does.
+     unsigned int find(unsigned int tag) const
+     {
+          for (unsigned int slot = home(tag);; slot = (slot + 1) & mask)
+          {
+               if (slots[slot].way == NONE)
+                    return ways;
+               if (slots[slot].tag == tag)
+                    return slots[slot].way;
+          }
+     }
+
+     void insert(unsigned int tag, unsigned int way);
+     void erase(unsigned int tag);
+
+     // Make `way` the most recently used, linking it if it is not yet listed.
+     void touch(unsigned int way)
+     {
+          Link &link = links[way];
+          if (link.next != NONE)
+          {
+               links[link.prev].next = link.next;
+               links[link.next].prev = link.prev;
+          }
+          Link &head = links[ways];
+          link.prev = head.prev;
+          link.next = ways;
+          links[head.prev].next = way;
+          head.prev = way;
+     }
+
+     // Take `way` out of the recency list.
+     void unlink(unsigned int way);
+
+     // Least recently used listed way, or `ways` if none is.
+     unsigned int lru() const { return links[ways].next; }
+
+private:
+     struct Slot
+     {
+          unsigned int tag;
+          unsigned int way; // NONE if the slot is empty
+     };
+
+     // Neighbours in the recency list. links[ways] is the sentinel: its next is the least
+     // and its prev the most recently used way.
+     struct Link
+     {
+          unsigned int prev;
+          unsigned int next; // NONE if the way is not listed
+     };
+
+     unsigned int home(unsigned int tag) const { return (tag * 0x9E3779B1u) >> shift; }
+
+     unsigned int ways = 0;
+     unsigned int mask = 0;
+     unsigned int shift = 0;
+     std::vector<Slot> slots;
+     std::vector<Link> links;
+};
+
+#endif // FULLY_ASSOCIATIVE_INDEX_HPP
@@ -0,0 +1,111 @@
+#ifndef HIT_PREDICTOR_HPP
+#define HIT_PREDICTOR_HPP
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint8_t, std::uint16_t, std::uint64_t
+#include <span>    // for std::span
+#include <vector>  // for std::vector
+
+#include "insertion_predictor.hpp"
+
+// Signature-based hit predictor (SHiP) for a last-level cache. Traces carry no PC, so a
+// block's signature is a hash of the address region it lies in. A table of saturating
+// counters learns per signature whether its blocks are hit again before they are evicted:
+// hits count up and evictions without a hit count down. A miss whose signature has counted
+// down to zero is predicted dead.
+class HitPredictor
+{
+public:
+     static constexpr unsigned int REGION_BITS = 12;    // 4 KiB address regions
+     static constexpr unsigned int SIGNATURE_BITS = 14; // 16K table entries
+     static constexpr std::uint8_t COUNTER_MAX = 7;     // 3-bit counters
+     static constexpr unsigned int BYPASS_PERIOD = 32;  // Predicted-dead misses per kept fill
+
+     // Outcomes, as counted since the last reset.
+     struct Counters
+     {
+          std::uint64_t dead_fills;   // Fills predicted dead
+          std::uint64_t live_fills;   // Fills predicted live
+          std::uint64_t bypasses;     // Misses predicted dead that skipped the cache
+          std::uint64_t dead_unused;  // Predicted dead, evicted without a hit
+          std::uint64_t dead_reused;  // Predicted dead, hit before eviction
+          std::uint64_t live_reused;  // Predicted live, hit before eviction
+          std::uint64_t live_unused;  // Predicted live, evicted without a hit
+     };
+
+     HitPredictor() = default;
+     HitPredictor(InsertionPredictor mode, unsigned int numSets, unsigned int assoc);
+
+     bool enabled() const { return mode != InsertionPredictor::None; }
+     InsertionPredictor getMode() const { return mode; }
+
+     // Whether a miss on `addr` should skip the cache. Predicted-dead misses do in bypass
+     // mode, except one in BYPASS_PERIOD, which fills so the table keeps learning.
+     bool bypass(unsigned int addr)
+     {
+          if (mode != InsertionPredictor::Bypass || table[signature(addr)] != 0)
+               return false;
+          if (++dead_misses % BYPASS_PERIOD == 0)
+               return false;
+          counters.bypasses++;
+          return true;
+     }
+
+     // `addr` was filled into `way` of `setIndex`. Returns whether it is predicted dead.
+     bool fill(unsigned int setIndex, unsigned int way, unsigned int addr);
+
+     // The block in `way` of `setIndex` was hit.
+     void hit(unsigned int setIndex, unsigned int way)
+     {
+          History &block = history[slot(setIndex, way)];
+          block.reused = 1;
+          if (table[block.signature] < COUNTER_MAX)
+               table[block.signature]++;
+     }
+
+     // The block in `way` of `setIndex` is being evicted.
+     void evict(unsigned int setIndex, unsigned int way);
+
+     const Counters &getCounters() const { return counters; }
+     void resetCounters() { counters = Counters{}; }
+
+     // Fraction of evicted blocks whose reuse was predicted correctly.
+     double accuracy() const;
+
+     // Add `other`'s counters to these and take its history of sets [first, end), and its
+     // table along with all of them. `other` has the same shape.
+     void merge(const HitPredictor &other, unsigned int first, unsigned int end);
+
+     // Table, block histories and counters as bytes, for checkpoints.
+     std::size_t savedBytes() const;
+     std::vector<unsigned char> save() const;
+     void restore(std::span<const unsigned char> bytes);
+
+private:
+     // What the predictor remembers about the block in one way.
+     struct History
+     {
+          std::uint16_t signature;
+          std::uint8_t reused;
+          std::uint8_t dead; // Predicted dead when filled
+     };
+
+     unsigned int signature(unsigned int addr) const
+     {
+          return ((addr >> REGION_BITS) * 0x9E3779B1u) >> (32 - SIGNATURE_BITS);
+     }
+     std::size_t slot(unsigned int setIndex, unsigned int way) const
+     {
+          return static_cast<std::size_t>(setIndex) * assoc + way;
+     }
+
+     InsertionPredictor mode = InsertionPredictor::None;
+     unsigned int numSets = 0;
+     unsigned int assoc = 0;
+     std::vector<std::uint8_t> table;
+     std::vector<History> history; // Per way, indexed like BlockData
+     std::uint64_t dead_misses = 0; // Predicted-dead misses seen in bypass mode
+     Counters counters{};
+};
+
+#endif // HIT_PREDICTOR_HPP
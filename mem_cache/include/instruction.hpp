@@ -1,15 +1,24 @@
 #ifndef INSTRUCTION_HPP
 #define INSTRUCTION_HPP
 
+#include <string>
+
+// One trace access, packed to 5 bytes with no padding. This is also the record layout of
+// raw binary traces, so a mapped trace file can be used as an Instruction array in place.
+#pragma pack(push, 1)
 class Instruction
 {
 public:
+     Instruction() = default;
      Instruction(unsigned short op, unsigned int address);
 
-     unsigned short op;
      unsigned int address;
+     unsigned char op;
 
      std::string to_string() const;
 };
+#pragma pack(pop)
+
+static_assert(sizeof(Instruction) == 5, "Instruction must stay packed");
 
 #endif // INSTRUCTION_HPP
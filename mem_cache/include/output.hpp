@@ -4,7 +4,7 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
-#include "address.hpp"
+#include "address_decoder.hpp"
 #include "block.hpp"
 #include "replacement_policy.hpp"
 
@@ -19,11 +19,11 @@ const int FORMAT_SPACE_RIGHT = 10;
           Output(std::string name, bool debug, unsigned int blocksize, 
                  unsigned int numSets, ReplacementPolicy replacement_policy)
               : name(name), debug(debug), blocksize(blocksize), numSets(numSets), 
-                replacement_policy(replacement_policy) {}
+                replacement_policy(replacement_policy), decoder(blocksize, numSets, false) {}
 
-          void address_output(const Address &address);
-          void block_output(Block &block);
-          void victim_output(Block &block);
+          void address_output(unsigned int addr);
+          void block_output(Block &block, unsigned int setIndex);
+          void victim_output(Block &block, unsigned int setIndex);
           void op_output(const std::string &op, unsigned int addr);
           void hit_output();
           void miss_output();
@@ -53,6 +53,7 @@ const int FORMAT_SPACE_RIGHT = 10;
           unsigned int blocksize;
           unsigned int numSets;
           ReplacementPolicy replacement_policy;
+          AddressDecoder decoder;
      };
 
 #endif // OUTPUT_HPP
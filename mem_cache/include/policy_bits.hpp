@@ -0,0 +1,134 @@
+#ifndef POLICY_BITS_HPP
+#define POLICY_BITS_HPP
+
+#include <bit>     // for std::countr_zero
+#include <cstdint> // for std::uint64_t
+
+// Replacement state that fits in one 64-bit word per set, updated without branches or scans.
+
+const unsigned int RANK_BITS = 4;
+const unsigned int RANKED_MAX_WAYS = 16;
+const unsigned int PLRU_MAX_WAYS = 64;
+
+// True LRU as the recency rank of every way, 0 for the most recently used, in 4-bit fields.
+// Fields are stored XOR RANK_IDENTITY so that a zeroed word reads as way i holding rank i,
+// which is a valid order to start from. Ways past the associativity keep ranks above every
+// real way's, so they never age into the victim's rank.
+const std::uint64_t RANK_IDENTITY = 0xFEDCBA9876543210;
+
+// Make `way` the most recently used: it takes rank 0 and every way ranked below it ages by one.
+inline std::uint64_t ranks_touch(std::uint64_t word, unsigned int way)
+{
+     const std::uint64_t LOW = 0x0F0F0F0F0F0F0F0F;
+     const std::uint64_t ONES = 0x0101010101010101;
+     const std::uint64_t HIGH = 0x8080808080808080;
+
+     std::uint64_t ranks = word ^ RANK_IDENTITY;
+     std::uint64_t rank = (ranks >> (way * RANK_BITS)) & 0xF;
+
+     // Compare even and odd fields in separate bytes, so a borrow stays within its byte: the
+     // high bit of a byte is left clear exactly where the field is below `rank`.
+     std::uint64_t even = ranks & LOW;
+     std::uint64_t odd = (ranks >> RANK_BITS) & LOW;
+     even += (~((even | HIGH) - rank * ONES) & HIGH) >> 7;
+     odd += (~((odd | HIGH) - rank * ONES) & HIGH) >> 7;
+
+     ranks = (even | (odd << RANK_BITS)) & ~(std::uint64_t{0xF} << (way * RANK_BITS));
+     return ranks ^ RANK_IDENTITY;
+}
+
+// The way holding `rank`.
+inline unsigned int ranks_find(std::uint64_t word, unsigned int rank)
+{
+     const std::uint64_t ONES = 0x1111111111111111;
+     const std::uint64_t LOW3 = 0x7777777777777777;
+     const std::uint64_t HIGH = 0x8888888888888888;
+
+     // A field is zero exactly where neither its top bit nor the carry out of its low three
+     // bits is set.
+     std::uint64_t diff = word ^ RANK_IDENTITY ^ (rank * ONES);
+     std::uint64_t zero = ~(((diff & LOW3) + LOW3) | diff) & HIGH;
+     return std::countr_zero(zero) / RANK_BITS;
+}
+
+// Tree pseudo-LRU over a power-of-two number of ways. Bit n is node n of the heap-ordered
+// tree, root 1, and points to the half the next victim is taken from: 0 left, 1 right.
+inline std::uint64_t tree_touch(std::uint64_t bits, unsigned int way, unsigned int ways)
+{
+     // Point every node on the path to `way` away from it.
+     unsigned int node = 1;
+     for (unsigned int half = ways / 2; half > 0; half /= 2)
+     {
+          std::uint64_t right = (way & half) != 0;
+          bits = (bits & ~(std::uint64_t{1} << node)) | ((right ^ 1) << node);
+          node = 2 * node + static_cast<unsigned int>(right);
+     }
+     return bits;
+}
+
+inline unsigned int tree_victim(std::uint64_t bits, unsigned int ways)
+{
+     unsigned int node = 1;
+     while (node < ways)
+          node = 2 * node + static_cast<unsigned int>((bits >> node) & 1);
+     return node - ways;
+}
+
+// Bit pseudo-LRU: one MRU bit per way. Once every way's bit is set, all but the newest are
+// cleared, and the victim is the first way whose bit is clear.
+inline std::uint64_t mru_touch(std::uint64_t bits, unsigned int way, unsigned int ways)
+{
+     std::uint64_t all = (ways == PLRU_MAX_WAYS) ? ~std::uint64_t{0}
+                                                 : (std::uint64_t{1} << ways) - 1;
+     bits |= std::uint64_t{1} << way;
+     return (bits == all) ? (std::uint64_t{1} << way) : bits;
+}
+
+inline unsigned int mru_victim(std::uint64_t bits)
+{
+     return std::countr_zero(~bits);
+}
+
+// Re-reference prediction values (RRIP): 2 bits per way, 32 ways to a word, way i in bits
+// 2i and 2i+1. A way predicted to be re-referenced soonest holds 0, one not expected to be
+// re-referenced RRPV_DISTANT.
+const unsigned int RRPV_BITS = 2;
+const unsigned int RRPV_WAYS_PER_WORD = 32;
+const unsigned int RRPV_LONG = 2;
+const unsigned int RRPV_DISTANT = 3;
+const unsigned int BIMODAL_PERIOD = 32; // BRRIP fills per long re-reference insertion
+const std::uint64_t RRPV_LOW = 0x5555555555555555; // Low bit of every field
+
+// Number of 64-bit words holding `ways` RRPVs.
+inline unsigned int rrpv_words(unsigned int ways)
+{
+     return (ways + RRPV_WAYS_PER_WORD - 1) / RRPV_WAYS_PER_WORD;
+}
+
+// Low bits of the fields in word `word` that belong to one of `ways` ways.
+inline std::uint64_t rrpv_fields(unsigned int ways, unsigned int word)
+{
+     unsigned int in_word = ways - word * RRPV_WAYS_PER_WORD;
+     if (in_word >= RRPV_WAYS_PER_WORD)
+          return RRPV_LOW;
+     return RRPV_LOW & ((std::uint64_t{1} << (in_word * RRPV_BITS)) - 1);
+}
+
+// Largest RRPV in `word`.
+inline unsigned int rrpv_max(std::uint64_t word)
+{
+     if (word & (word >> 1) & RRPV_LOW)
+          return RRPV_DISTANT;
+     if (word & ~RRPV_LOW)
+          return RRPV_LONG;
+     return (word != 0) ? 1 : 0;
+}
+
+// Low bits of the fields equal to `value`, among `fields`.
+inline std::uint64_t rrpv_equal(std::uint64_t word, unsigned int value, std::uint64_t fields)
+{
+     std::uint64_t diff = word ^ (value * RRPV_LOW);
+     return ~(diff | (diff >> 1)) & fields;
+}
+
+#endif // POLICY_BITS_HPP
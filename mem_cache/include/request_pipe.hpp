@@ -0,0 +1,80 @@
+#ifndef REQUEST_PIPE_HPP
+#define REQUEST_PIPE_HPP
+
+#include <cstddef> // for std::size_t
+#include <span>    // for std::span
+#include <vector>  // for std::vector
+
+#include "instruction.hpp"
+#include "memory_access.hpp"
+#include "spsc_queue.hpp"
+
+// The reads and writes one cache sends to the level below it, carried to a consumer thread in
+// order. Requests are gathered into fixed batches that travel through a lock-free ring, and
+// drained batches come back through a second one, so the queues are touched once per batch
+// and nothing is allocated after construction.
+class RequestPipe
+{
+public:
+     using Batch = std::vector<Instruction>;
+
+     static constexpr std::size_t DEFAULT_BATCH_SIZE = 4096;
+     static constexpr std::size_t DEFAULT_NUM_BATCHES = 8;
+
+     explicit RequestPipe(std::size_t batch_size = DEFAULT_BATCH_SIZE,
+                          std::size_t num_batches = DEFAULT_NUM_BATCHES)
+         : batch_size(batch_size), batches(num_batches), filled(num_batches),
+           empty(num_batches)
+     {
+          for (auto &batch : batches)
+          {
+               batch.reserve(batch_size);
+               empty.push(&batch);
+          }
+          empty.pop(current);
+     }
+
+     RequestPipe(const RequestPipe &) = delete;
+     RequestPipe &operator=(const RequestPipe &) = delete;
+
+     // Producer side
+     void push(MemoryAccess op, unsigned int address)
+     {
+          current->emplace_back(static_cast<unsigned short>(op), address);
+          if (current->size() == batch_size)
+          {
+               filled.push(current);
+               empty.pop(current);
+          }
+     }
+
+     // Sends the partial batch and ends the stream.
+     void close()
+     {
+          if (!current->empty())
+               filled.push(current);
+          filled.close();
+     }
+
+     // Consumer side: calls handle(batch) with every batch of requests, in order, until closed.
+     template <typename Handler>
+     void drain(Handler &&handle)
+     {
+          Batch *batch;
+          while (filled.pop(batch))
+          {
+               handle(std::span<const Instruction>(*batch));
+               batch->clear();
+               empty.push(batch);
+          }
+     }
+
+private:
+     std::size_t batch_size;
+     std::vector<Batch> batches;
+     SpscQueue<Batch *> filled;
+     SpscQueue<Batch *> empty;
+     Batch *current = nullptr; // Producer's batch being filled
+};
+
+#endif // REQUEST_PIPE_HPP
@@ -1,77 +1,492 @@
 #ifndef SET_HPP
 #define SET_HPP
 
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
-#include <vector>
-#include <queue>
-#include "address.hpp"
+#include <string>
 #include "block.hpp"
+#include "fully_associative_index.hpp"
+#include "policy_bits.hpp"
+#include "set_dueling.hpp"
+#include "replacement_policy.hpp"
+#include "set_policy.hpp"
+#include "set_trace.hpp"
+#include "tag_match.hpp"
 
+// Counters of one set, at the start of its slab record. A whole number of 64-bit words, so
+// the masks that follow stay 8-byte aligned.
+struct SetState
+{
+     unsigned int size;
+     unsigned int LRU;         // Clock stamped into LRU_counters on each use
+     unsigned int open_block;
+     unsigned int trace_idx;
+     unsigned int FIFO_head;   // Ring position of the oldest way
+     unsigned int FIFO_count;  // Ways in the ring
+     std::uint64_t policy_bits; // Packed LRU ranks or pseudo-LRU bits, see policy_bits.hpp
+     unsigned int bimodal_fills; // Fills since BRRIP last inserted at long re-reference
+};
+
+// What every set of a cache shares: geometry, options, and where each per-set array starts
+// within a set's record. Built by CacheSlab.
+struct SetLayout
+{
+     unsigned int assoc;
+     ReplacementPolicy replacement_policy;
+     bool debug;
+     bool main_memory;
+     std::string cache_name;
+
+     std::size_t valid_offset;
+     std::size_t dirty_offset;
+     std::size_t tags_offset;
+     std::size_t LRU_offset;
+     std::size_t FIFO_offset;
+     std::size_t next_use_offset; // Present only for optimal replacement
+     std::size_t RRPV_offset;     // Present only for RRIP replacement
+     std::size_t stride; // Bytes per set record, a whole number of host cache lines
+};
+
+// View of one set's record in its cache's slab. Views are cheap to make and copy, and only
+// valid while the slab they point into lives.
 class Set
 {
 public:
-     Set(unsigned int assoc, unsigned int blocksize, ReplacementPolicy replacement_policy,
-         const std::string cache_name, bool debug);
+     Set(const SetLayout &layout, std::byte *record, unsigned int set_index,
+         std::optional<SetTrace> trace, FullyAssociativeIndex *index = nullptr,
+         SetDueling *dueling = nullptr);
 
-     void initialize(const Address &addr);
+     bool isFull() const { return state().size == layout->assoc; }
 
-     std::vector<Block> blocks;
-     std::queue<unsigned int> FIFO_indices;
-     std::vector<unsigned int> LRU_counters;
-     std::vector<Address> trace;
+     // The access paths are compiled per replacement policy and, optionally, per associativity
+     // so that tag compares unroll and policy updates inline. Ways = DYNAMIC_WAYS reads the
+     // associativity from the layout instead.
+     template <SetPolicy Policy, unsigned int Ways = DYNAMIC_WAYS>
+     std::optional<Victim> write(unsigned int tag);
+     template <SetPolicy Policy, unsigned int Ways = DYNAMIC_WAYS>
+     std::optional<Victim> allocate(unsigned int tag);
 
-     bool isFull() const { return size == capacity; }
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     std::optional<Block> search(unsigned int tag);
+     std::optional<Block> read(unsigned int tag) { return search(tag); }
 
-     std::optional<std::reference_wrapper<Block>> read(const Address &addr);
-     std::optional<std::reference_wrapper<Block>> write(const Address &addr);
-     std::optional<std::reference_wrapper<Block>> write(const Block &block);
-     std::optional<std::reference_wrapper<Block>> search(const Address &addr);
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     unsigned int getIdx(unsigned int tag) const;
 
-     std::optional<std::reference_wrapper<Block>> allocate(const Address &addr);
-     unsigned int getIdx(const Address &addr) const;
+     // Index of the first valid way holding `tag`, or `assoc` if there is none.
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     unsigned int find(unsigned int tag) const;
 
-     
-     void fillBlock(const Block &addr);
-     void delete_block(const Address &addr);
+     // Tag and state of `way`, valid or not.
+     Block block(unsigned int way) const;
 
-     void increaseSize() { size++; }
-     unsigned int getSize() { return size; }
+     void delete_block(unsigned int tag);
+
+     void increaseSize() { state().size++; }
+     unsigned int getSize() { return state().size; }
 
      // Replacement policy methods
-     Block replaceBlock_FIFO(const Address &addr);
+     Victim replaceBlock_FIFO(unsigned int tag);
+     template <unsigned int Ways = DYNAMIC_WAYS>
      unsigned int get_FIFO_replacement();
 
+     template <unsigned int Ways = DYNAMIC_WAYS>
      unsigned int get_LRU_replacement();
-     void update_LRU(unsigned int idx);
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     void update_LRU(unsigned int idx)
+     {
+          SetState &s = state();
+          if (ranked<Ways>())
+               s.policy_bits = ranks_touch(s.policy_bits, idx);
+          else
+          {
+               LRU_counters()[idx] = s.LRU;
+               s.LRU++;
+               if constexpr (Ways == INDEXED_WAYS)
+                    index->touch(idx);
+          }
+          update_policy_output();
+     }
+
+     template <ReplacementPolicy Kind, unsigned int Ways = DYNAMIC_WAYS>
+     unsigned int get_PLRU_replacement() const
+     {
+          // Direct mapped cache always replaces the same block.
+          if (ways<Ways>() == 1)
+               return 0;
 
+          if constexpr (Kind == ReplacementPolicy::TreePLRU)
+               return tree_victim(state().policy_bits, ways<Ways>());
+          else
+               return mru_victim(state().policy_bits);
+     }
+     template <ReplacementPolicy Kind, unsigned int Ways = DYNAMIC_WAYS>
+     void update_PLRU(unsigned int idx)
+     {
+          SetState &s = state();
+          if constexpr (Kind == ReplacementPolicy::TreePLRU)
+               s.policy_bits = tree_touch(s.policy_bits, idx, ways<Ways>());
+          else
+               s.policy_bits = mru_touch(s.policy_bits, idx, ways<Ways>());
+          update_policy_output();
+     }
+
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     unsigned int get_RRIP_replacement();
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     unsigned int peek_RRIP_replacement() const;
+     template <unsigned int Ways = DYNAMIC_WAYS>
+     void update_RRPV(unsigned int idx, unsigned int rrpv)
+     {
+          std::uint64_t &word = RRPVs()[idx / RRPV_WAYS_PER_WORD];
+          unsigned int shift = (idx % RRPV_WAYS_PER_WORD) * RRPV_BITS;
+          word = (word & ~(std::uint64_t{RRPV_DISTANT} << shift)) |
+                 (std::uint64_t{rrpv} << shift);
+          update_policy_output();
+     }
+     // RRPV a block filled on a miss starts at. Counts the miss for set dueling.
+     template <ReplacementPolicy Kind>
+     unsigned int RRIP_insertion();
+
+     template <unsigned int Ways = DYNAMIC_WAYS>
      unsigned int get_optimal_replacement();
-     void update_optimal() { trace_idx++; }
+     void update_optimal() { state().trace_idx++; }
 
-     void mark_used(unsigned int address, std::vector<unsigned int> &indices);
+     // Refill the index from the record, after the record was overwritten in place.
+     void rebuild_index();
+     // Find each way's next use again from trace_idx, after the record was overwritten.
+     void restamp_next_uses();
 
      void print_contents();
      void print_trace();
-     void update_policy_output();
+     void update_policy_output()
+     {
+          if (layout->debug && !layout->main_memory)
+               policy_output();
+     }
      void dirty_output();
 
 private:
-     void leftOut(std::string input);
-     void outRight(std::string input);
-     
-     
+     // Associativity the access paths were compiled for.
+     template <unsigned int Ways>
+     unsigned int ways() const
+     {
+          if constexpr (Ways == DYNAMIC_WAYS || Ways == INDEXED_WAYS)
+               return layout->assoc;
+          else
+               return Ways;
+     }
 
-     bool debug;
+     // Whether LRU order is kept as packed ranks rather than per-way stamps.
+     template <unsigned int Ways>
+     bool ranked() const
+     {
+          if constexpr (Ways == INDEXED_WAYS)
+               return false;
+          else
+               return ways<Ways>() <= RANKED_MAX_WAYS;
+     }
 
-     unsigned int LRU;
-     unsigned int size;
-     unsigned int capacity;
-     unsigned int assoc;
-     unsigned int blocksize;
-     unsigned int open_block;
-     unsigned int trace_idx;
+     // Per-set arrays within the record.
+     SetState &state() const { return *reinterpret_cast<SetState *>(record); }
+     std::uint64_t *valid_bits() const { return words(layout->valid_offset); }
+     std::uint64_t *dirty_bits() const { return words(layout->dirty_offset); }
+     unsigned int *tags() const { return ints(layout->tags_offset); }
+     unsigned int *LRU_counters() const { return ints(layout->LRU_offset); }
+     unsigned int *FIFO_order() const { return ints(layout->FIFO_offset); }
+     unsigned int *next_uses() const { return ints(layout->next_use_offset); }
+     std::uint64_t *RRPVs() const { return words(layout->RRPV_offset); }
 
-     const std::string cache_name;
-     ReplacementPolicy replacement_policy;
+     std::uint64_t *words(std::size_t offset) const
+     {
+          return reinterpret_cast<std::uint64_t *>(record + offset);
+     }
+     unsigned int *ints(std::size_t offset) const
+     {
+          return reinterpret_cast<unsigned int *>(record + offset);
+     }
+
+     // Put a block with `tag` in the first empty way.
+     template <SetPolicy Policy, unsigned int Ways>
+     void fill(unsigned int tag, bool dirty);
+
+     // Put a new block with `tag` in `way` and describe the block it displaced.
+     template <unsigned int Ways>
+     Victim replace(unsigned int way, unsigned int tag, bool dirty);
+     template <unsigned int Ways>
+     void push_FIFO(unsigned int way);
+     void stamp_next_use(unsigned int way);
+     void remove_FIFO(unsigned int way);
+     void policy_output();
+
+     const SetLayout *layout;
+     std::byte *record;
+     std::optional<SetTrace> trace; // Accesses mapping to this set, for optimal replacement
+     FullyAssociativeIndex *index;  // Only for INDEXED_WAYS
+     SetDueling *dueling;           // Only for DRRIP
+     unsigned int set_index;
 };
 
+template <SetPolicy Policy, unsigned int Ways>
+std::optional<Victim> Set::write(unsigned int tag)
+{
+     unsigned int way = find<Ways>(tag);
+     if (way < ways<Ways>())
+     {
+          dirty_bits()[word_of(way)] |= bit_of(way);
+          Policy::template write_hit<Ways>(*this, tag);
+          return std::nullopt; // Hit, no victim
+     }
+
+     // If the set is not yet full, fill an empty block.
+     if (!isFull())
+     {
+          fill<Policy, Ways>(tag, true);
+          return std::nullopt; // Empty block, no victim
+     }
+
+     // Otherwise, replace the policy's victim.
+     return replace<Ways>(Policy::template victim<Ways>(*this), tag, true);
+}
+
+template <SetPolicy Policy, unsigned int Ways>
+std::optional<Victim> Set::allocate(unsigned int tag)
+{
+     // If the set is not yet full, fill an empty block.
+     if (!isFull())
+     {
+          fill<Policy, Ways>(tag, false);
+          return std::nullopt; // Empty block, no victim
+     }
+
+     // Otherwise, replace the policy's victim.
+     return replace<Ways>(Policy::template victim<Ways>(*this), tag, false);
+}
+
+template <unsigned int Ways>
+std::optional<Block> Set::search(unsigned int tag)
+{
+     unsigned int way = find<Ways>(tag);
+     if (way < ways<Ways>())
+          return block(way);
+
+     return std::nullopt; // Miss
+}
+
+template <unsigned int Ways>
+unsigned int Set::find(unsigned int tag) const
+{
+     if constexpr (Ways == INDEXED_WAYS)
+          return index->find(tag);
+     else
+          return find_tag(tags(), ways<Ways>(), tag, valid_bits());
+}
+
+template <unsigned int Ways>
+unsigned int Set::getIdx(unsigned int tag) const
+{
+     // Ways fill in order and are never invalidated, so empty ways all follow the valid ones
+     // and hold no tag that a valid way does: the index finds the same way as a scan.
+     if constexpr (Ways == INDEXED_WAYS)
+     {
+          unsigned int way = index->find(tag);
+          return (way < ways<Ways>()) ? way : UINT_MAX;
+     }
+
+     // Matches empty ways too, like the replacement bookkeeping expects.
+     unsigned int way = find_tag_any(tags(), ways<Ways>(), tag);
+     if (way < ways<Ways>())
+          return way;
+
+     return UINT_MAX; // Not found
+}
+
+template <SetPolicy Policy, unsigned int Ways>
+void Set::fill(unsigned int tag, bool dirty)
+{
+     SetState &s = state();
+     const std::uint64_t *valid = valid_bits();
+     for (unsigned int word = 0; word * MASK_BITS < ways<Ways>(); word++)
+     {
+          if (~valid[word] != 0)
+          {
+               s.open_block = word * MASK_BITS + std::countr_zero(~valid[word]);
+               break;
+          }
+     }
+
+     // Update replacement policy.
+     push_FIFO<Ways>(s.open_block);
+     Policy::template insert<Ways>(*this, s.open_block);
+     if constexpr (Ways == INDEXED_WAYS)
+          index->insert(tag, s.open_block);
+
+     // Otherwise, insert block at the current open position and look for other open spot.
+     tags()[s.open_block] = tag;
+     valid_bits()[word_of(s.open_block)] |= bit_of(s.open_block);
+     if (dirty)
+          dirty_bits()[word_of(s.open_block)] |= bit_of(s.open_block);
+     else
+          dirty_bits()[word_of(s.open_block)] &= ~bit_of(s.open_block);
+     stamp_next_use(s.open_block);
+     s.size++;
+}
+
+template <unsigned int Ways>
+Victim Set::replace(unsigned int way, unsigned int tag, bool dirty)
+{
+     std::uint64_t &dirty_word = dirty_bits()[word_of(way)];
+     Victim victim{tags()[way], way, (dirty_word & bit_of(way)) != 0};
+
+     tags()[way] = tag;
+     if (dirty)
+          dirty_word |= bit_of(way);
+     else
+          dirty_word &= ~bit_of(way);
+     stamp_next_use(way);
+
+     if constexpr (Ways == INDEXED_WAYS)
+     {
+          index->erase(victim.tag);
+          index->insert(tag, way);
+     }
+     return victim;
+}
+
+template <unsigned int Ways>
+void Set::push_FIFO(unsigned int way)
+{
+     SetState &s = state();
+     FIFO_order()[(s.FIFO_head + s.FIFO_count) % ways<Ways>()] = way;
+     s.FIFO_count++;
+}
+
+template <unsigned int Ways>
+unsigned int Set::get_LRU_replacement()
+{
+     // Direct mapped cache always replaces the same block.
+     if (ways<Ways>() == 1)
+          return 0;
+
+     // The index lists the ways in stamp order.
+     if constexpr (Ways == INDEXED_WAYS)
+          return index->lru();
+
+     if (ranked<Ways>())
+          return ranks_find(state().policy_bits, ways<Ways>() - 1);
+
+     // The way with the oldest stamp.
+     const unsigned int *counters = LRU_counters();
+     return std::min_element(counters, counters + ways<Ways>()) - counters;
+}
+
+template <unsigned int Ways>
+unsigned int Set::get_FIFO_replacement()
+{
+     update_policy_output();
+
+     // Direct mapped cache always replaces the same block.
+     if (ways<Ways>() == 1)
+          return 0;
+
+     // The ring is full, so the oldest way becomes the newest by rotating it.
+     SetState &s = state();
+     unsigned int victim_idx = FIFO_order()[s.FIFO_head];
+     s.FIFO_head = (s.FIFO_head + 1) % ways<Ways>();
+     return victim_idx;
+}
+
+template <unsigned int Ways>
+unsigned int Set::get_RRIP_replacement()
+{
+     // Direct mapped cache always replaces the same block.
+     if (ways<Ways>() == 1)
+          return 0;
+
+     // Age every way at once by as much as brings the furthest to distant re-reference, where
+     // one at a time would repeat until some way got there. The victim is the first way there.
+     std::uint64_t *rrpv = RRPVs();
+     unsigned int count = rrpv_words(ways<Ways>());
+     unsigned int furthest = 0;
+     for (unsigned int word = 0; word < count; word++)
+          furthest = std::max(furthest, rrpv_max(rrpv[word]));
+     if (furthest < RRPV_DISTANT)
+     {
+          for (unsigned int word = 0; word < count; word++)
+               rrpv[word] += (RRPV_DISTANT - furthest) * rrpv_fields(ways<Ways>(), word);
+     }
+     return peek_RRIP_replacement<Ways>();
+}
+
+template <unsigned int Ways>
+unsigned int Set::peek_RRIP_replacement() const
+{
+     // Direct mapped cache always replaces the same block.
+     if (ways<Ways>() == 1)
+          return 0;
+
+     // Aging preserves order, so the victim is the first way with the largest RRPV.
+     const std::uint64_t *rrpv = RRPVs();
+     unsigned int count = rrpv_words(ways<Ways>());
+     unsigned int furthest = 0;
+     for (unsigned int word = 0; word < count; word++)
+          furthest = std::max(furthest, rrpv_max(rrpv[word]));
+     for (unsigned int word = 0;; word++)
+     {
+          std::uint64_t match = rrpv_equal(rrpv[word], furthest, rrpv_fields(ways<Ways>(), word));
+          if (match != 0)
+               return word * RRPV_WAYS_PER_WORD + std::countr_zero(match) / RRPV_BITS;
+     }
+}
+
+template <ReplacementPolicy Kind>
+unsigned int Set::RRIP_insertion()
+{
+     // DRRIP's leader sets use SRRIP (A) or BRRIP (B); the others follow the better.
+     bool bimodal = (Kind == ReplacementPolicy::BRRIP);
+     if constexpr (Kind == ReplacementPolicy::DRRIP)
+          bimodal = dueling->miss(set_index);
+
+     // SRRIP inserts at long re-reference. BRRIP inserts at distant, and at long only once
+     // every BIMODAL_PERIOD fills of a set.
+     if (!bimodal)
+          return RRPV_LONG;
+     SetState &s = state();
+     if (++s.bimodal_fills < BIMODAL_PERIOD)
+          return RRPV_DISTANT;
+     s.bimodal_fills = 0;
+     return RRPV_LONG;
+}
+
+template <unsigned int Ways>
+unsigned int Set::get_optimal_replacement()
+{
+     update_policy_output();
+
+     // Direct mapped cache always replaces the same block.
+     if (ways<Ways>() == 1)
+          return 0;
+
+     // Each way holds the position of its tag's next use as of when it was filled. Uses that
+     // the trace has since passed are stale, so follow the links to the first one still ahead.
+     unsigned int window = state().trace_idx;
+     unsigned int *next = next_uses();
+     unsigned int victim_idx = 0;
+     for (unsigned int way = 0; way < ways<Ways>(); way++)
+     {
+          while (next[way] < window)
+               next[way] = trace->next_use(next[way]);
+
+          // The block reused last, or never. Ties among the never reused go to the first way.
+          if (next[way] > next[victim_idx])
+               victim_idx = way;
+     }
+
+     return victim_idx;
+}
+
 #endif // SET_HPP
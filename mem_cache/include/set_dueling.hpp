@@ -0,0 +1,52 @@
+#ifndef SET_DUELING_HPP
+#define SET_DUELING_HPP
+
+// Chooses between two replacement policies, A and B, by set dueling. A few leader sets always
+// use A and as many always use B; their misses move a saturating selector (PSEL), and every
+// other set follows whichever policy is missing less. Caches with fewer than four sets have no
+// leaders, and all their sets follow A.
+class SetDueling
+{
+public:
+     static constexpr unsigned int DEFAULT_LEADERS = 32; // Leader sets per policy
+     static constexpr unsigned int DEFAULT_PSEL_BITS = 10;
+
+     SetDueling() = default;
+     explicit SetDueling(unsigned int numSets, unsigned int leaders = DEFAULT_LEADERS,
+                         unsigned int psel_bits = DEFAULT_PSEL_BITS);
+
+     // Count a miss in `set` and say whether it should insert as policy B.
+     bool miss(unsigned int set)
+     {
+          if (constituency == 0)
+               return false;
+
+          unsigned int offset = set & (constituency - 1);
+          if (offset == 0)
+          {
+               if (psel < psel_max) psel++; // A missed
+               return false;
+          }
+          if (offset == constituency / 2)
+          {
+               if (psel > 0) psel--; // B missed
+               return true;
+          }
+          return useB();
+     }
+
+     // Whether followers use policy B: A's leaders have missed more.
+     bool useB() const { return psel > psel_max / 2; }
+
+     unsigned int getPsel() const { return psel; }
+     void setPsel(unsigned int value) { psel = value; }
+
+private:
+     // Sets are grouped into runs of `constituency` sets, each led by its first set for A and
+     // its middle set for B. Zero if there are no leaders.
+     unsigned int constituency = 0;
+     unsigned int psel_max = 0;
+     unsigned int psel = 0;
+};
+
+#endif // SET_DUELING_HPP
@@ -0,0 +1,160 @@
+#ifndef SET_POLICY_HPP
+#define SET_POLICY_HPP
+
+#include <concepts> // for std::same_as, std::convertible_to
+
+#include "replacement_policy.hpp"
+
+class Set;
+
+// Ways of a set specialized without a compile-time associativity; read from its layout.
+const unsigned int DYNAMIC_WAYS = 0;
+
+// Ways of a cache's only set, looked up through its FullyAssociativeIndex rather than scanned.
+const unsigned int INDEXED_WAYS = ~0u;
+
+// A replacement policy a set's hot path is compiled for. `Ways` is the set's compile-time
+// associativity, INDEXED_WAYS or DYNAMIC_WAYS.
+//   victim     picks the way to replace in a full set and does the policy's bookkeeping for it
+//   insert     does the bookkeeping for a fill of the empty way `way`
+//   reference  does the bookkeeping for a read hit on `way`
+//   write_hit  does the bookkeeping for a write hit on `tag`
+//   peek       names the way debug output shows as the next victim, without changing anything
+template <typename Policy>
+concept SetPolicy = requires(Set &set, unsigned int tag, unsigned int way) {
+     { Policy::kind } -> std::convertible_to<ReplacementPolicy>;
+     { Policy::template victim<DYNAMIC_WAYS>(set) } -> std::same_as<unsigned int>;
+     { Policy::template insert<DYNAMIC_WAYS>(set, way) } -> std::same_as<void>;
+     { Policy::template reference<DYNAMIC_WAYS>(set, way) } -> std::same_as<void>;
+     { Policy::template write_hit<DYNAMIC_WAYS>(set, tag) } -> std::same_as<void>;
+     { Policy::template peek<DYNAMIC_WAYS>(set) } -> std::same_as<unsigned int>;
+};
+
+// LRU order is kept for every policy built on this, and debug output previews the LRU way
+// as the next victim for all of them.
+struct RecencyTracking
+{
+     template <unsigned int Ways, typename S>
+     static void insert(S &set, unsigned int way) { set.template update_LRU<Ways>(way); }
+
+     template <unsigned int Ways, typename S>
+     static void reference(S &set, unsigned int way) { set.template update_LRU<Ways>(way); }
+
+     template <unsigned int Ways, typename S>
+     static unsigned int peek(S &set) { return set.template get_LRU_replacement<Ways>(); }
+};
+
+struct LruPolicy : RecencyTracking
+{
+     static constexpr ReplacementPolicy kind = ReplacementPolicy::LRU;
+
+     template <unsigned int Ways, typename S>
+     static unsigned int victim(S &set)
+     {
+          unsigned int way = set.template get_LRU_replacement<Ways>();
+          set.template update_LRU<Ways>(way);
+          return way;
+     }
+
+     template <unsigned int Ways, typename S>
+     static void write_hit(S &set, unsigned int tag)
+     {
+          set.template update_LRU<Ways>(set.template getIdx<Ways>(tag));
+     }
+};
+
+struct FifoPolicy : RecencyTracking
+{
+     static constexpr ReplacementPolicy kind = ReplacementPolicy::FIFO;
+
+     template <unsigned int Ways, typename S>
+     static unsigned int victim(S &set) { return set.template get_FIFO_replacement<Ways>(); }
+
+     // Hits do not change the fill order.
+     template <unsigned int Ways, typename S>
+     static void write_hit(S &, unsigned int) {}
+};
+
+struct OptimalPolicy : RecencyTracking
+{
+     static constexpr ReplacementPolicy kind = ReplacementPolicy::Optimal;
+
+     template <unsigned int Ways, typename S>
+     static unsigned int victim(S &set) { return set.template get_optimal_replacement<Ways>(); }
+
+     // Next uses come from the trace, not from hits.
+     template <unsigned int Ways, typename S>
+     static void write_hit(S &, unsigned int) {}
+};
+
+// Pseudo-LRU policies keep only their own bits, and debug output previews their own victim.
+template <ReplacementPolicy Kind>
+struct PseudoLruPolicy
+{
+     static constexpr ReplacementPolicy kind = Kind;
+
+     template <unsigned int Ways, typename S>
+     static unsigned int victim(S &set)
+     {
+          unsigned int way = set.template get_PLRU_replacement<Kind, Ways>();
+          set.template update_PLRU<Kind, Ways>(way);
+          return way;
+     }
+
+     template <unsigned int Ways, typename S>
+     static void insert(S &set, unsigned int way) { set.template update_PLRU<Kind, Ways>(way); }
+
+     template <unsigned int Ways, typename S>
+     static void reference(S &set, unsigned int way) { set.template update_PLRU<Kind, Ways>(way); }
+
+     template <unsigned int Ways, typename S>
+     static void write_hit(S &set, unsigned int tag)
+     {
+          set.template update_PLRU<Kind, Ways>(set.template getIdx<Ways>(tag));
+     }
+
+     template <unsigned int Ways, typename S>
+     static unsigned int peek(S &set) { return set.template get_PLRU_replacement<Kind, Ways>(); }
+};
+
+using TreePlruPolicy = PseudoLruPolicy<ReplacementPolicy::TreePLRU>;
+using BitPlruPolicy = PseudoLruPolicy<ReplacementPolicy::BitPLRU>;
+
+// RRIP policies: fills start at the insertion RRPV and hits predict a near re-reference.
+template <ReplacementPolicy Kind>
+struct RripPolicy
+{
+     static constexpr ReplacementPolicy kind = Kind;
+
+     template <unsigned int Ways, typename S>
+     static unsigned int victim(S &set)
+     {
+          unsigned int way = set.template get_RRIP_replacement<Ways>();
+          set.template update_RRPV<Ways>(way, set.template RRIP_insertion<Kind>());
+          return way;
+     }
+
+     template <unsigned int Ways, typename S>
+     static void insert(S &set, unsigned int way)
+     {
+          set.template update_RRPV<Ways>(way, set.template RRIP_insertion<Kind>());
+     }
+
+     template <unsigned int Ways, typename S>
+     static void reference(S &set, unsigned int way) { set.template update_RRPV<Ways>(way, 0); }
+
+     template <unsigned int Ways, typename S>
+     static void write_hit(S &set, unsigned int tag)
+     {
+          set.template update_RRPV<Ways>(set.template getIdx<Ways>(tag), 0);
+     }
+
+     template <unsigned int Ways, typename S>
+     static unsigned int peek(S &set) { return set.template peek_RRIP_replacement<Ways>(); }
+};
+
+using SrripPolicy = RripPolicy<ReplacementPolicy::SRRIP>;
+using BrripPolicy = RripPolicy<ReplacementPolicy::BRRIP>;
+using DrripPolicy = RripPolicy<ReplacementPolicy::DRRIP>;
+
+#endif // SET_POLICY_HPP
@@ -0,0 +1,81 @@
+#ifndef SET_TRACE_HPP
+#define SET_TRACE_HPP
+
+#include <climits> // for UINT_MAX
+#include <cstddef> // for std::size_t
+#include <span>    // for std::span
+#include <vector>  // for std::vector
+
+#include "address_decoder.hpp"
+#include "instruction.hpp"
+
+class SetTrace;
+
+// A cache's view of the trace for optimal replacement: every access's position in the shared
+// trace, grouped by set with one counting sort. Positions within a set are in trace order and
+// addressed by their local index. Each access is linked to the next access of its tag, and each
+// set's indices are also kept sorted by tag, so "when is this tag used next" costs one link or
+// one binary search, never a scan. Tags are decoded from the trace, which must outlive this.
+class SetTraces
+{
+public:
+     static constexpr unsigned int NEVER = UINT_MAX;
+
+     SetTraces() = default;
+     SetTraces(std::span<const Instruction> trace, const AddressDecoder &decoder,
+               unsigned int numSets);
+
+     SetTrace set(unsigned int setIndex) const;
+
+private:
+     friend class SetTrace;
+
+     unsigned int tag(unsigned int position) const
+     {
+          return decoder.tag(trace[position].address);
+     }
+
+     std::span<const Instruction> trace;
+     AddressDecoder decoder;
+     std::vector<unsigned int> offsets;   // Start of each set's accesses; numSets + 1 entries
+     std::vector<unsigned int> positions; // Trace positions, grouped by set
+     std::vector<unsigned int> next;      // Parallel to `positions`: local index or NEVER
+     std::vector<unsigned int> by_tag;    // Each set's local indices ordered by (tag, index)
+};
+
+// The accesses that map to one set, in order.
+class SetTrace
+{
+public:
+     static constexpr unsigned int NEVER = SetTraces::NEVER;
+
+     SetTrace(const SetTraces &traces, unsigned int setIndex)
+         : traces(&traces), begin(traces.offsets[setIndex]),
+           end(traces.offsets[setIndex + 1])
+     {
+     }
+
+     std::size_t size() const { return end - begin; }
+     unsigned int operator[](std::size_t i) const
+     {
+          return traces->tag(traces->positions[begin + i]);
+     }
+
+     // Index of the next access after `i` to the same tag, or NEVER.
+     unsigned int next_use(unsigned int i) const { return traces->next[begin + i]; }
+
+     // Index of the first access at or after `from` to `tag`, or NEVER.
+     unsigned int first_use(unsigned int tag, unsigned int from) const;
+
+private:
+     const SetTraces *traces;
+     unsigned int begin;
+     unsigned int end;
+};
+
+inline SetTrace SetTraces::set(unsigned int setIndex) const
+{
+     return SetTrace(*this, setIndex);
+}
+
+#endif // SET_TRACE_HPP
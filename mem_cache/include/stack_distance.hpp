@@ -0,0 +1,159 @@
+#ifndef STACK_DISTANCE_HPP
+#define STACK_DISTANCE_HPP
+
+#include <cstddef>       // for std::size_t
+#include <cstdint>       // for std::uint64_t
+#include <ostream>       // for std::ostream
+#include <set>           // for std::set
+#include <span>          // for std::span
+#include <unordered_map> // for std::unordered_map
+#include <utility>       // for std::pair
+#include <vector>        // for std::vector
+
+#include "address_decoder.hpp"
+#include "instruction.hpp"
+
+// Spatial sampling for StackDistance. The defaults sample everything, which is exact.
+struct SweepSampling
+{
+     double rate = 1.0;      // Fraction of the blocks or sets tracked, in (0, 1]
+     std::size_t budget = 0; // Most blocks tracked at once, lowering the rate; 0: no limit
+};
+
+// LRU hit and miss counts for every power-of-two cache size and associativity of one block
+// size, from a single pass over the trace (Mattson's stack algorithm).
+//
+// Under LRU an access hits a cache of associativity A iff fewer than A other blocks of its set
+// were used since its block's last use, its stack distance. Caches with the same number of sets
+// see the same sets, so one histogram of distances per set count serves every associativity.
+// Within each set, the distance is the number of blocks whose last use falls after this block's,
+// which a Fenwick tree over the set's access times counts in logarithmic time.
+//
+// Writes allocate and every access counts as a use, as in Cache with LRU replacement, so the
+// counts equal those of a single-level sim_cache run.
+//
+// Sampled, each set count tracks only the accesses whose key hashes below a threshold (SHARDS,
+// Waldspurger et al.). With many sets the key is the set index, so whole sets are tracked
+// exactly; with few, it is the block prefix, and distances among the sampled blocks are scaled
+// up by the rate. The sample's read and write miss ratios are applied to the trace's exact
+// access counts, so how many sets or blocks happen to pass the threshold does not bias the
+// estimate (the correction SHARDS-adj makes). With a budget, an overflowing set count lowers its threshold to its largest tracked hash and forgets
+// what no longer passes, down to a floor that keeps the sample meaningful. Stacks are also cut
+// at the depth past which every cache misses, so memory is fixed by the budget and the
+// geometry, not the trace.
+//
+// The sample is also split by hash into GROUPS independent parts, each a smaller sample of
+// the same sets or blocks. The spread of their miss rates estimates the standard error, which
+// Student's t turns into a 95% interval, widened to at least the binomial error of the
+// sampled references. This is a heuristic: sets that behave very differently, few sampled
+// sets or scaled block distances can put the true rate outside it.
+class StackDistance
+{
+public:
+     static constexpr unsigned int GROUPS = 16;
+
+     // One cache's counts.
+     struct Result
+     {
+          unsigned int size;
+          unsigned int assoc;
+          unsigned int reads;
+          unsigned int read_misses;
+          unsigned int writes;
+          unsigned int write_misses;
+          double miss_rate; // As Cache::calculate_miss_rate reports it
+          double error;     // Half-width of an approximate 95% interval; 0 when exact
+     };
+
+     // Covers caches of min_size to max_size bytes. Throws std::invalid_argument unless all
+     // three are powers of two with blocksize <= min_size <= max_size and the rate is valid.
+     StackDistance(unsigned int blocksize, unsigned int min_size, unsigned int max_size,
+                   SweepSampling sampling = SweepSampling());
+
+     void access(const Instruction &instruction);
+     void add(std::span<const Instruction> chunk);
+
+     // Every cache size, smallest first, each with associativity 1 up to fully associative.
+     std::vector<Result> results() const;
+
+     // results() as a whitespace-separated table with a header line. Sampled tables have an
+     // error column.
+     void print(std::ostream &out) const;
+
+     bool isSampled() const { return sampled; }
+
+     // Getters
+     std::uint64_t getNumAccesses() const { return reads + writes; }
+     std::size_t getNumTracked() const { return slots.size(); }
+     double getMinRate() const;
+
+private:
+     static constexpr std::uint64_t MODULUS = std::uint64_t{1} << 24;
+
+     // Access times of one set's blocks. A time is marked while it is the last use of its block.
+     struct SetClock
+     {
+          std::vector<unsigned int> tree;  // Fenwick tree over the marks, 1-based
+          std::vector<unsigned int> owner; // Block slot of each marked time, or FREE
+          unsigned int now = 0;            // Times handed out since the last rebuild
+          unsigned int live = 0;           // Marked times
+     };
+
+     // Sets, sample and histograms of one set count.
+     struct Level
+     {
+          unsigned int numSets;
+          unsigned int max_assoc; // Distances at or past this are misses for every cache here
+          bool by_set;            // Sampling key: the set index rather than the block
+          std::uint64_t threshold = MODULUS; // Keys hashing below this are tracked
+          std::uint64_t floor = 0;           // Lowest threshold the budget may impose
+          std::size_t live = 0;              // Blocks tracked
+          std::uint64_t samples = 0;         // Accesses tracked
+          std::set<std::pair<std::uint64_t, unsigned int>> keys; // Tracked (hash, key), budgeted
+          std::vector<SetClock> sets;
+          std::vector<double> read_hist;  // Weights by group, then distance; last bucket: misses
+          std::vector<double> write_hist;
+     };
+
+     unsigned int distance(SetClock &set, unsigned int level, unsigned int slot);
+     void rebuild(SetClock &set, unsigned int level);
+     unsigned int slot_of(unsigned int block_prefix);
+     void forget(unsigned int level, unsigned int slot);
+     void shrink(unsigned int level);
+
+     // Weighted accesses and misses of `assoc` ways in groups [first_group, end_group) of
+     // `level`'s sample.
+     struct Tally
+     {
+          double reads = 0.0;
+          double read_misses = 0.0;
+          double writes = 0.0;
+          double write_misses = 0.0;
+     };
+
+     Tally tally(const Level &level, unsigned int assoc, unsigned int first_group,
+                 unsigned int end_group) const;
+     // Estimated read and write misses over the whole trace, from a tally's miss ratios.
+     std::pair<double, double> misses(const Tally &tally) const;
+     double error(const Level &level, unsigned int size, unsigned int assoc,
+                  const Result &estimate) const;
+     Result result(unsigned int size, unsigned int assoc,
+                   std::pair<double, double> misses) const;
+
+     AddressDecoder decoder;
+     unsigned int blocksize;
+     unsigned int min_size;
+     unsigned int max_size;
+     bool sampled;
+     std::size_t level_budget;
+     std::vector<Level> levels; // levels[k] has 2^k sets
+     std::unordered_map<unsigned int, unsigned int> slots; // Block prefix to slot
+     std::vector<unsigned int> prefixes;   // Slot to block prefix
+     std::vector<unsigned int> refs;       // Per slot: levels tracking the block
+     std::vector<unsigned int> free_slots; // Slots of forgotten blocks
+     std::vector<unsigned int> last; // Per slot and level: the block's marked time, 0 if none
+     std::uint64_t reads = 0;
+     std::uint64_t writes = 0;
+};
+
+#endif // STACK_DISTANCE_HPP
@@ -0,0 +1,88 @@
+#ifndef TAG_MATCH_HPP
+#define TAG_MATCH_HPP
+
+#include <algorithm> // for std::min
+#include <bit>       // for std::countr_zero
+#include <cstdint>   // for std::uint64_t
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Ways compared per step. Tag arrays are padded to a multiple of this, and a group of lanes
+// never straddles a 64-bit mask word.
+#if defined(__AVX2__)
+const unsigned int TAG_LANES = 8;
+#elif defined(__SSE2__)
+const unsigned int TAG_LANES = 4;
+#else
+const unsigned int TAG_LANES = 1;
+#endif
+
+const unsigned int MASK_BITS = 64;
+
+// Word and bit of `way` in a per-set mask.
+inline unsigned int word_of(unsigned int way) { return way / MASK_BITS; }
+inline std::uint64_t bit_of(unsigned int way) { return std::uint64_t{1} << (way % MASK_BITS); }
+
+// Number of tag slots to allocate for `ways` ways.
+inline unsigned int padded_ways(unsigned int ways)
+{
+     return (ways + TAG_LANES - 1) / TAG_LANES * TAG_LANES;
+}
+
+// Number of 64-bit mask words covering `ways` ways.
+inline unsigned int mask_words(unsigned int ways)
+{
+     return (padded_ways(ways) + MASK_BITS - 1) / MASK_BITS;
+}
+
+// Bit i is set if tags[i] == tag, for the TAG_LANES tags starting at `tags`.
+inline unsigned int tag_match_lanes(const unsigned int *tags, unsigned int tag)
+{
+#if defined(__AVX2__)
+     __m256i key = _mm256_set1_epi32(static_cast<int>(tag));
+     __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tags));
+     __m256i equal = _mm256_cmpeq_epi32(lanes, key);
+     return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+#elif defined(__SSE2__)
+     __m128i key = _mm_set1_epi32(static_cast<int>(tag));
+     __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags));
+     __m128i equal = _mm_cmpeq_epi32(lanes, key);
+     return static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+#else
+     return tags[0] == tag;
+#endif
+}
+
+// Returns the first way below `ways` holding `tag` whose bit is set in `mask`, or `ways` if
+// there is none. `tags` must hold padded_ways(ways) entries and `mask` mask_words(ways) words.
+inline unsigned int find_tag(const unsigned int *tags, unsigned int ways, unsigned int tag,
+                             const std::uint64_t *mask)
+{
+     for (unsigned int i = 0; i < ways; i += TAG_LANES)
+     {
+          std::uint64_t lanes = mask[i / MASK_BITS] >> (i % MASK_BITS);
+          std::uint64_t hits = tag_match_lanes(tags + i, tag) & lanes;
+          if (hits != 0)
+               return i + std::countr_zero(hits);
+     }
+     return ways;
+}
+
+// Returns the first way below `ways` holding `tag`, valid or not, or `ways` if there is none.
+// Padding slots only follow the last way, so a match there means no way matched.
+inline unsigned int find_tag_any(const unsigned int *tags, unsigned int ways, unsigned int tag)
+{
+     for (unsigned int i = 0; i < ways; i += TAG_LANES)
+     {
+          unsigned int hits = tag_match_lanes(tags + i, tag);
+          if (hits != 0)
+               return std::min(i + static_cast<unsigned int>(std::countr_zero(hits)), ways);
+     }
+     return ways;
+}
+
+#endif // TAG_MATCH_HPP
@@ -0,0 +1,35 @@
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "address_decoder.hpp"
+
+#define ADDRESS_BITS 32
+
+// Floor of log base 2, for n > 0.
+static unsigned int log2(unsigned int n)
+{
+     return std::bit_width(n) - 1;
+}
+
+AddressDecoder::AddressDecoder(unsigned int blocksize, unsigned int numSets, bool validate_sets)
+{
+     if (!std::has_single_bit(blocksize))
+          throw std::invalid_argument("block size " + std::to_string(blocksize) +
+                                      " is not a power of two");
+
+     if (validate_sets && !std::has_single_bit(numSets))
+          throw std::invalid_argument("number of sets " + std::to_string(numSets) +
+                                      " (size / (blocksize * assoc)) is not a power of two");
+
+     // Unvalidated set counts (main memory) round down, leaving the top sets unused.
+     unsigned int indexLength = numSets > 1 ? log2(numSets) : 0;
+     offsetLength = log2(blocksize);
+     tagShift = offsetLength + indexLength;
+
+     if (tagShift >= ADDRESS_BITS)
+          throw std::invalid_argument("block size times number of sets exceeds the address space");
+
+     offsetMask = (1u << offsetLength) - 1;
+     indexMask = (1u << indexLength) - 1;
+}
@@ -0,0 +1,35 @@
+#include <algorithm>
+
+#include "block_data.hpp"
+
+BlockData::BlockData(unsigned int numSets, unsigned int assoc, unsigned int blocksize)
+    : assoc(assoc), blocksize(blocksize),
+      bytes(static_cast<std::size_t>(numSets) * assoc * blocksize)
+{
+}
+
+std::span<unsigned char> BlockData::line(unsigned int setIndex, unsigned int way)
+{
+     return std::span<unsigned char>(bytes).subspan(offset(setIndex, way), blocksize);
+}
+
+std::span<const unsigned char> BlockData::line(unsigned int setIndex, unsigned int way) const
+{
+     return std::span<const unsigned char>(bytes).subspan(offset(setIndex, way), blocksize);
+}
+
+void BlockData::clear(unsigned int setIndex, unsigned int way)
+{
+     std::ranges::fill(line(setIndex, way), 0);
+}
+
+void BlockData::copySets(const BlockData &other, unsigned int first, unsigned int end)
+{
+     std::copy(other.bytes.begin() + offset(first, 0), other.bytes.begin() + offset(end, 0),
+               bytes.begin() + offset(first, 0));
+}
+
+std::size_t BlockData::offset(unsigned int setIndex, unsigned int way) const
+{
+     return (static_cast<std::size_t>(setIndex) * assoc + way) * blocksize;
+}
@@ -1,8 +1,10 @@
+#include <bit>
 #include <iostream>
 #include <iomanip>
 #include <optional>
+#include <stdexcept>
 
-#include "address.hpp"
+#include "address_decoder.hpp"
 #include "block.hpp"
 #include "cache.hpp"
 #include "instruction.hpp"
@@ -13,67 +15,97 @@
 #define MISS std::nullopt
 #define LOAD_FAILURE std::nullopt
 #define EMPTY_BLOCK std::nullopt
+#define NO_VICTIM std::nullopt
 
 #define VERBOSE true
+#define MAX_FIXED_WAYS 16 // Widest associativity with its own compiled path
 
 // Constructor implementation
 Cache::Cache(const std::string name, unsigned int blocksize, unsigned int size,
              unsigned int assoc,
              ReplacementPolicy replacement_policy, InclusionProperty inclusion_property,
-             std::vector<Instruction> &instructions, bool debug)
+             std::span<const Instruction> instructions, bool debug, bool store_data,
+             InsertionPredictor insertion_predictor)
 
     : name(name), blocksize(blocksize), size(size), assoc(assoc),
       replacement_policy(replacement_policy), inclusion_property(inclusion_property),
       numAccesses(0), reads(0), read_misses(0), writes(0), write_misses(0), write_backs(0),
-      miss_rate(0.0), debug(debug)
+      miss_rate(0.0), debug(debug), main_memory(name == "MAIN_MEMORY")
 {
      // Calculate number of sets.
-     numSets = size / (blocksize * assoc);
+     numSets = (blocksize * assoc == 0) ? 0 : size / (blocksize * assoc);
 
-     // Initialize the cache with Set objects, each set containing `assoc` blocks.
-     for (unsigned int i = 0; i < numSets; ++i)
+     // Main memory is direct mapped over the sum of the cache sizes, which need not be a
+     // power of two, so only real caches have their geometry validated.
+     try
      {
-          auto defaultAddr = Address(0, blocksize, numSets);
-          cache.emplace_back(Set(assoc, blocksize, replacement_policy, name, debug));
-          cache[i].initialize(defaultAddr);
-          // cache[i].increaseSize();
+          decoder = AddressDecoder(blocksize, numSets, !main_memory);
      }
+     catch (const std::invalid_argument &e)
+     {
+          throw std::invalid_argument(name + ": " + e.what());
+     }
+
+     // Pseudo-LRU state is a single word per set.
+     bool pseudo_LRU = replacement_policy == ReplacementPolicy::TreePLRU ||
+                       replacement_policy == ReplacementPolicy::BitPLRU;
+     if (pseudo_LRU && !main_memory && assoc > PLRU_MAX_WAYS)
+          throw std::invalid_argument(name + ": pseudo-LRU supports at most " +
+                                      std::to_string(PLRU_MAX_WAYS) + " ways");
+     if (replacement_policy == ReplacementPolicy::TreePLRU && !main_memory &&
+         !std::has_single_bit(assoc))
+          throw std::invalid_argument(name + ": tree pseudo-LRU needs a power-of-two "
+                                      "associativity");
+
+     // Lay out the metadata of all sets, each containing `assoc` empty blocks.
+     slab = CacheSlab(numSets, assoc, replacement_policy, name, debug);
+
+     // Payload bytes are only allocated when asked for; main memory never stores any.
+     if (store_data && !main_memory)
+          data = BlockData(numSets, assoc, blocksize);
+
+     // A predictor learns from the blocks this cache holds, so main memory never has one.
+     if (insertion_predictor != InsertionPredictor::None && !main_memory)
+          predictor = HitPredictor(insertion_predictor, numSets, assoc);
 
      // Construct set traces for Optimal replacement policy.
      if (replacement_policy == ReplacementPolicy::Optimal)
           construct_set_traces(instructions);
+
+     // A single set wider than the fixed-way paths is looked up through a hash of its tags.
+     if (numSets == 1 && assoc > MAX_FIXED_WAYS && !main_memory)
+          fa_index = FullyAssociativeIndex(assoc);
+
+     // DRRIP's sets duel SRRIP insertion (A) against BRRIP insertion (B).
+     if (replacement_policy == ReplacementPolicy::DRRIP && !main_memory)
+          dueling = SetDueling(numSets);
+
+     engine = select_engine(replacement_policy, assoc, fa_index.enabled(), main_memory);
 }
 
-std::optional<std::reference_wrapper<Block>> Cache::read(unsigned int addr)
+template <SetPolicy Policy, unsigned int Ways>
+std::optional<Block> Cache::read_as(unsigned int addr)
 {
      // Increment cache accesses.
      access();
      reads++;
      op_output("read", addr);
 
-     auto address = Address(addr, blocksize, numSets);
-     Set &set = cache[address.setIndex];
-
-     // For main memory, reads never miss, so we return a valid block.
-     if (name == "MAIN_MEMORY")
-     {
-          // Block &newBlock = *(new Block(blocksize, address));
-          Block block(blocksize, address);
-          Block &newBlock = block;
-          return newBlock;
-     }
+     unsigned int tag = decoder.tag(addr);
+     Set set = set_as<Policy, Ways>(decoder.setIndex(addr));
 
      // Read from current cache.
-     auto result = set.search(address);
+     auto result = set.template search<Ways>(tag);
      if (result)
      {
-          Block &found_block = result->get();
           hit_output();
-          unsigned int idx = set.getIdx(address);
-          set.update_LRU(idx);
+          unsigned int idx = set.template getIdx<Ways>(tag);
+          Policy::template reference<Ways>(set, idx);
+          if (predictor.enabled())
+               predictor.hit(decoder.setIndex(addr), idx);
           
           set.update_optimal();
-          return found_block;
+          return result;
      }
 
      // If we miss, read from lower level caches.
@@ -84,13 +116,15 @@ std::optional<std::reference_wrapper<Block>> Cache::read(unsigned int addr)
           set.update_optimal();
           if (next_mem_level != NULL)
           {
-               allocate(addr);
-               auto result = next_mem_level->read(addr);
+               // A block predicted dead is read around this cache.
+               if (predictor.enabled() && predictor.bypass(addr))
+                    bypass_output();
+               else
+                    allocate_as<Policy, Ways>(addr);
+               auto result = next_read(addr);
                if (result)
                {
-                    Block &loaded_block = result->get();
-                    
-                    return loaded_block;
+                    return result;
                }
           }
      }
@@ -100,44 +134,45 @@ std::optional<std::reference_wrapper<Block>> Cache::read(unsigned int addr)
      return LOAD_FAILURE;
 }
 
-std::optional<std::reference_wrapper<Block>> Cache::allocate(unsigned int addr)
+template <SetPolicy Policy, unsigned int Ways>
+std::optional<Victim> Cache::allocate_as(unsigned int addr)
 {
-
-     // The only modifications to memory should be done with write, not allocate.
-     if (name == "MAIN_MEMORY")
-     {
-          return EMPTY_BLOCK;
-     }
-
      // access(); Shouldn't access because we accessed during read or write to get here?
      // writes++;
 
      // Decode address.
-     auto address = Address(addr, blocksize, numSets);
-     Set &set = cache[address.setIndex];
+     unsigned int tag = decoder.tag(addr);
+     unsigned int setIndex = decoder.setIndex(addr);
+     Set set = set_as<Policy, Ways>(setIndex);
 
      // Victim output
-     auto hit = set.search(address);
-     if (hit)
-     {
-     }
-     else if (!set.isFull())
+     if (debug)
      {
-          no_victim_output();
-     }
-     else
-     {
-          unsigned int victim_idx = set.get_LRU_replacement();
-          victim_output(set.blocks[victim_idx]);
+          auto hit = set.template search<Ways>(tag);
+          if (hit)
+          {
+          }
+          else if (!set.isFull())
+          {
+               no_victim_output();
+          }
+          else
+          {
+               unsigned int victim_idx = Policy::template peek<Ways>(set);
+               Block block = set.block(victim_idx);
+               victim_output(Victim{block.getTag(), victim_idx, block.isDirty()}, setIndex);
+          }
      }
 
      // Write to the set marked by the address's set index.
      bool displaced_victim = false;
-     auto victim = set.allocate(address);
+     auto victim = set.template allocate<Policy, Ways>(tag);
+     clear_data(setIndex, tag);
+     if (predictor.enabled())
+          predict_fill<Policy, Ways>(set, setIndex, addr, victim);
      if (victim)
      {
-          Block victim_block = victim->get();
-          // victim_output(victim_block);
+          // victim_output(*victim);
           displaced_victim = true;
      }
      else
@@ -148,14 +183,12 @@ std::optional<std::reference_wrapper<Block>> Cache::allocate(unsigned int addr)
      // If we evicted a block during allocation, write back to next level of memory.
      if (displaced_victim)
      {
-          Block victim_block = victim->get();
-          if (victim_block.isDirty() && next_mem_level != NULL)
+          if (victim->dirty && next_mem_level != NULL)
           {
                write_backs++;
-               next_mem_level->write(victim_block.getAddress().value);
+               next_write(decoder.blockAddress(victim->tag, setIndex));
           }
-          Block &victim_ref = victim_block;
-          return victim_ref;
+          return victim;
      }
 
      // Maintain inclusive property.
@@ -164,44 +197,39 @@ std::optional<std::reference_wrapper<Block>> Cache::allocate(unsigned int addr)
           // If block was evicted, remove it from lower level caches.
           if (displaced_victim)
           {
-               Block victim_block = victim->get();
-               unsigned int victim_address = victim_block.getAddress().value;
+               unsigned int victim_address = decoder.blockAddress(victim->tag, setIndex);
                prev_mem_level->delete_block(victim_address);
           }
      }
 
      // No victim block.
-     return EMPTY_BLOCK;
+     return NO_VICTIM;
 }
 
-std::optional<std::reference_wrapper<Block>> Cache::write(unsigned int addr)
+template <SetPolicy Policy, unsigned int Ways>
+std::optional<Victim> Cache::write_as(unsigned int addr)
 {
      // Increment cache accesses.
      access();
      writes++;
      op_output("write", addr);
 
-     // For main memory, writes never miss and no victim exists.
-     if (name == "MAIN_MEMORY")
-     {
-          return EMPTY_BLOCK;
-     }
-
-     // op_output("write", addr); Put it here to remove MAIN_MEMORY output
-
      // Decode address.
-     auto address = Address(addr, blocksize, numSets);
-     Set &set = cache[address.setIndex];
+     unsigned int tag = decoder.tag(addr);
+     unsigned int setIndex = decoder.setIndex(addr);
+     Set set = set_as<Policy, Ways>(setIndex);
 
      // Load block if it already exists in cache.
      bool miss_flag = false;
-     std::optional<std::reference_wrapper<Block>> found_block = EMPTY_BLOCK;
-     auto result = set.search(address);
+     std::optional<Block> found_block = EMPTY_BLOCK;
+     auto result = set.template search<Ways>(tag);
      if (result)
      {
-          found_block = result->get();
+          found_block = result;
           hit_output();
           set.update_optimal();
+          if (predictor.enabled())
+               predictor.hit(setIndex, set.template find<Ways>(tag));
      }
 
      // If we miss, attempt to update block read from lower level caches.
@@ -212,19 +240,30 @@ std::optional<std::reference_wrapper<Block>> Cache::write(unsigned int addr)
           miss_output();
      }
 
-     Block block(blocksize, address);
+     // A write predicted dead goes straight to the next level, without allocating.
+     if (miss_flag && next_mem_level != NULL && predictor.enabled() && predictor.bypass(addr))
+     {
+          bypass_output();
+          next_write(addr);
+          set.update_optimal();
+          return NO_VICTIM;
+     }
+
      if (miss_flag && next_mem_level != NULL)
      {
-          found_block = next_mem_level->read(addr);
+          found_block = next_read(addr);
      }
 
      // Write to the set marked by the address's set index.
-     auto victim = set.write(block);
+     auto victim = set.template write<Policy, Ways>(tag);
+     if (miss_flag)
+          clear_data(setIndex, tag);
+     if (miss_flag && predictor.enabled())
+          predict_fill<Policy, Ways>(set, setIndex, addr, victim);
      bool displaced_victim = false;
      if (victim)
      {
-          Block victim_block = victim->get();
-          victim_output(victim_block);
+          victim_output(*victim, setIndex);
           displaced_victim = true;
      }
      else
@@ -233,16 +272,14 @@ std::optional<std::reference_wrapper<Block>> Cache::write(unsigned int addr)
      // If we evicted a block during writing, write back to next level of memory.
      if (displaced_victim)
      {
-          Block victim_block = victim->get();
-          if (victim_block.isDirty() && next_mem_level != NULL)
+          if (victim->dirty && next_mem_level != NULL)
           {
                write_backs++;
-               next_mem_level->write(victim_block.getAddress().value);
+               next_write(decoder.blockAddress(victim->tag, setIndex));
           }
-          Block &victim_ref = victim_block;
           set.dirty_output();
           set.update_optimal();
-          return victim_ref;
+          return victim;
      }
 
      // Maintain inclusive property.
@@ -251,8 +288,7 @@ std::optional<std::reference_wrapper<Block>> Cache::write(unsigned int addr)
           // If block was evicted, remove it from lower level caches.
           if (displaced_victim)
           {
-               Block victim_block = victim->get();
-               unsigned int victim_address = victim_block.getAddress().value;
+               unsigned int victim_address = decoder.blockAddress(victim->tag, setIndex);
                prev_mem_level->delete_block(victim_address);
           }
      }
@@ -261,28 +297,159 @@ std::optional<std::reference_wrapper<Block>> Cache::write(unsigned int addr)
      
      set.dirty_output();
      set.update_optimal();
-     return EMPTY_BLOCK;
+     return NO_VICTIM;
 }
 
-std::optional<std::reference_wrapper<Block>> Cache::search(unsigned int addr)
+// For main memory, reads never miss, so we return a valid block.
+std::optional<Block> Cache::read_main_memory(unsigned int addr)
 {
-     // Decode address.
-     auto address = Address(addr, blocksize, numSets);
+     access();
+     reads++;
+     return Block(decoder.tag(addr));
+}
+
+// For main memory, writes never miss and no victim exists.
+std::optional<Victim> Cache::write_main_memory(unsigned int /*addr*/)
+{
+     access();
+     writes++;
+     return NO_VICTIM;
+}
+
+// The only modifications to memory should be done with write, not allocate.
+std::optional<Victim> Cache::allocate_main_memory(unsigned int /*addr*/)
+{
+     return NO_VICTIM;
+}
+
+template <SetPolicy Policy, unsigned int Ways>
+Cache::Engine Cache::engine_of()
+{
+     return {&Cache::read_as<Policy, Ways>, &Cache::write_as<Policy, Ways>,
+             &Cache::allocate_as<Policy, Ways>};
+}
+
+// Common associativities get a path with the ways known at compile time, and one wide set
+// a path through its index.
+template <SetPolicy Policy>
+Cache::Engine Cache::engine_for(unsigned int assoc, bool indexed)
+{
+     if (indexed)
+          return engine_of<Policy, INDEXED_WAYS>();
+
+     switch (assoc)
+     {
+          case 1: return engine_of<Policy, 1>();
+          case 2: return engine_of<Policy, 2>();
+          case 4: return engine_of<Policy, 4>();
+          case 8: return engine_of<Policy, 8>();
+          case 16: return engine_of<Policy, 16>();
+          default: return engine_of<Policy, DYNAMIC_WAYS>();
+     }
+}
+
+Cache::Engine Cache::select_engine(ReplacementPolicy replacement_policy, unsigned int assoc,
+                                   bool indexed, bool main_memory)
+{
+     if (main_memory)
+          return {&Cache::read_main_memory, &Cache::write_main_memory,
+                  &Cache::allocate_main_memory};
+
+     switch (replacement_policy)
+     {
+          case ReplacementPolicy::LRU: return engine_for<LruPolicy>(assoc, indexed);
+          case ReplacementPolicy::FIFO: return engine_for<FifoPolicy>(assoc, indexed);
+          case ReplacementPolicy::TreePLRU: return engine_for<TreePlruPolicy>(assoc, indexed);
+          case ReplacementPolicy::BitPLRU: return engine_for<BitPlruPolicy>(assoc, indexed);
+          case ReplacementPolicy::SRRIP: return engine_for<SrripPolicy>(assoc, indexed);
+          case ReplacementPolicy::BRRIP: return engine_for<BrripPolicy>(assoc, indexed);
+          case ReplacementPolicy::DRRIP: return engine_for<DrripPolicy>(assoc, indexed);
+          case ReplacementPolicy::Optimal: break;
+     }
+     return engine_for<OptimalPolicy>(assoc, indexed);
+}
+
+void Cache::resetCounters()
+{
+     numAccesses = reads = read_misses = writes = write_misses = write_backs = 0;
+     miss_rate = 0.0;
+     predictor.resetCounters();
+}
+
+void Cache::mergeSets(const Cache &other, unsigned int first_set, unsigned int end_set)
+{
+     slab.copySets(other.slab, first_set, end_set);
+     if (data.enabled())
+          data.copySets(other.data, first_set, end_set);
+
+     numAccesses += other.numAccesses;
+     reads += other.reads;
+     read_misses += other.read_misses;
+     writes += other.writes;
+     write_misses += other.write_misses;
+     write_backs += other.write_backs;
+
+     if (first_set < end_set)
+          rebuildIndex();
+
+     if (predictor.enabled())
+          predictor.merge(other.predictor, first_set, end_set);
+
+     // The dueling selector is shared by all sets, so it only carries over with all of them.
+     if (first_set == 0 && end_set == numSets)
+          dueling = other.dueling;
+}
 
+void Cache::rebuildIndex()
+{
+     if (fa_index.enabled())
+          slab.set(0, std::nullopt, &fa_index).rebuild_index();
+}
+
+void Cache::restampNextUses()
+{
+     if (replacement_policy != ReplacementPolicy::Optimal || main_memory)
+          return;
+
+     for (unsigned int setIndex = 0; setIndex < numSets; setIndex++)
+          set_at(setIndex).restamp_next_uses();
+}
+
+// Requests to the next level. A pipelined level sees them later, on its own thread, so the
+// block read is stood in for by its tag here.
+std::optional<Block> Cache::next_read(unsigned int addr)
+{
+     if (downstream != NULL)
+     {
+          downstream->push(MemoryAccess::Read, addr);
+          return Block(decoder.tag(addr));
+     }
+     return next_mem_level->read(addr);
+}
+
+void Cache::next_write(unsigned int addr)
+{
+     if (downstream != NULL)
+          downstream->push(MemoryAccess::Write, addr);
+     else
+          next_mem_level->write(addr);
+}
+
+std::optional<Block> Cache::search(unsigned int addr)
+{
      // Search for block in the specified set.
-     Set &set = cache[address.setIndex];
+     Set set = set_at(decoder.setIndex(addr));
 
-     return set.search(address);
+     return set.search(decoder.tag(addr));
 }
 
-std::optional<std::reference_wrapper<Block>> Cache::load(unsigned int addr)
+std::optional<Block> Cache::load(unsigned int addr)
 {
      // Load block from current cache, if present.
      auto result = search(addr);
      if (result)
      {
-          Block& found_block = result->get();
-          return found_block;
+          return result;
      }
 
      // Load from lower level caches, if any.
@@ -290,44 +457,116 @@ std::optional<std::reference_wrapper<Block>> Cache::load(unsigned int addr)
           return next_mem_level->load(addr);
 
      // Load from main memory if not found in any cache.
-     if (name == "MAIN_MEMORY")
+     if (main_memory)
      {
-          auto address = Address(addr, blocksize, numSets);
-          Block &newBlock = *(new Block(blocksize, address));
-          return newBlock;
+          return Block(decoder.tag(addr));
      }
 
      // Reached main memory and failed to load.
      return LOAD_FAILURE;
 }
 
-void Cache::delete_block(unsigned int addr)
+template <SetPolicy Policy, unsigned int Ways>
+Set Cache::set_as(unsigned int setIndex)
+{
+     FullyAssociativeIndex *index = (Ways == INDEXED_WAYS) ? &fa_index : nullptr;
+     if constexpr (Policy::kind == ReplacementPolicy::Optimal)
+          return slab.set(setIndex, set_traces.set(setIndex), index);
+     else if constexpr (Policy::kind == ReplacementPolicy::DRRIP)
+          return slab.set(setIndex, std::nullopt, index, &dueling);
+     else
+          return slab.set(setIndex, std::nullopt, index);
+}
+
+template <SetPolicy Policy, unsigned int Ways>
+void Cache::predict_fill(Set &set, unsigned int setIndex, unsigned int addr,
+                         const std::optional<Victim> &victim)
+{
+     unsigned int way = victim ? victim->way : set.template find<Ways>(decoder.tag(addr));
+     if (victim)
+          predictor.evict(setIndex, way);
+     bool dead = predictor.fill(setIndex, way, addr);
+
+     // Under RRIP a block predicted dead is inserted as the next to be replaced.
+     if constexpr (isRRIP(Policy::kind))
+     {
+          if (dead)
+               set.template update_RRPV<Ways>(way, RRPV_DISTANT);
+     }
+}
+
+Set Cache::set_at(unsigned int setIndex) const
+{
+     if (replacement_policy != ReplacementPolicy::Optimal)
+          return slab.set(setIndex);
+
+     return slab.set(setIndex, set_traces.set(setIndex));
+}
+
+unsigned char Cache::readByte(unsigned int addr, std::size_t index) const
+{
+     return data.line(decoder.setIndex(addr), resident_way(addr))[checked_offset(index)];
+}
+
+void Cache::writeByte(unsigned int addr, std::size_t index, unsigned char value)
+{
+     data.line(decoder.setIndex(addr), resident_way(addr))[checked_offset(index)] = value;
+}
+
+unsigned int Cache::resident_way(unsigned int addr) const
 {
-     if (name == "MAIN_MEMORY")
+     if (!data.enabled())
+          throw std::logic_error(name + ": block data is not stored in tag-only mode");
+
+     Set set = set_at(decoder.setIndex(addr));
+     unsigned int way = set.find(decoder.tag(addr));
+     if (way == assoc)
+          throw std::out_of_range(name + ": block is not resident");
+
+     return way;
+}
+
+std::size_t Cache::checked_offset(std::size_t index) const
+{
+     if (index >= blocksize)
+          throw std::out_of_range("Index out of bounds");
+
+     return index;
+}
+
+void Cache::clear_data(unsigned int setIndex, unsigned int tag)
+{
+     if (!data.enabled())
           return;
 
-     // Decode address.
-     auto address = Address(addr, blocksize, numSets);
+     data.clear(setIndex, set_at(setIndex).find(tag));
+}
 
-     // Search for block in the specified set.
-     Set &set = cache[address.setIndex];
+void Cache::delete_block(unsigned int addr)
+{
+     if (main_memory)
+          return;
+
+     // Search for block in the specified set, keeping a wide set's index in step.
+     Set set = slab.set(decoder.setIndex(addr), std::nullopt,
+                        fa_index.enabled() ? &fa_index : nullptr);
 
-     set.delete_block(address);
+     set.delete_block(decoder.tag(addr));
 
      // Maintain inclusion property.
      if (inclusion_property == InclusionProperty::Inclusive && next_mem_level != NULL)
           next_mem_level->delete_block(addr);
 }
 
-void Cache::update_optimal(unsigned int addr)
+    double
+    Cache::calculate_miss_rate()
 {
-     auto address = Address(addr, blocksize, numSets);
-
-     return;
+     miss_rate = miss_rate_of(reads, read_misses, writes, write_misses);
+     return miss_rate;
 }
 
-    double
-    Cache::calculate_miss_rate()
+double Cache::miss_rate_of(unsigned int reads, unsigned int read_misses, unsigned int writes,
+                           unsigned int write_misses)
 {
      if (reads + writes == 0) return 0.0;
      unsigned int wrongs;
@@ -339,41 +578,21 @@ void Cache::update_optimal(unsigned int addr)
      {
           wrongs = writes;
      }
-     miss_rate = static_cast<double>(read_misses + write_misses) / (reads + wrongs);
-     return miss_rate;
+     return static_cast<double>(read_misses + write_misses) / (reads + wrongs);
 }
 
-void Cache::construct_set_traces(std::vector<Instruction> &instructions)
+void Cache::construct_set_traces(std::span<const Instruction> instructions)
 {
-     for (auto &instruction : instructions)
-     {
-
-          // Extract address from instruction.
-          auto address = Address(instruction.address, blocksize, numSets);
-
-          for (int curr_set = 0; curr_set < numSets; curr_set++)
-          {
-               // Append address to set trace if it maps to the current set.
-               if (address.setIndex == curr_set)
-               {
-                    // Get current set.
-                    Set &set = cache[curr_set];
-                    set.trace.push_back(address);
-                    break;
-               }
-          }
-     }
+     // Group the accesses by set in one pass, as positions into the shared trace.
+     set_traces = SetTraces(instructions, decoder, numSets);
 
      // std::cout << "CACHE: " << name << std::endl;
-     // for (int i = 0; i < cache.size(); i++)
+     // for (int i = 0; i < numSets; i++)
      // {
      //      std::cout << "Set " << i << " trace: " << std::endl;
-     //      for (auto addr : cache[i].trace)
-     //      {
-     //           std::cout << "  Address:  " << addr << std::endl;
-     //           std::cout << "  Block: " << addr.blockToString() << std::endl;
-     //           std::cout << std::endl;
-     //      }
+     //      SetTrace set_trace = set_traces.set(i);
+     //      for (std::size_t j = 0; j < set_trace.size(); j++)
+     //           std::cout << "  Tag: " << std::hex << set_trace[j] << std::dec << std::endl;
      // }
 }
 
@@ -383,38 +602,37 @@ void Cache::print_contents()
      {
           std::string set = std::to_string(i) + ":";
           Output::leftOut("Set"); Output::leftOut(set);
-          cache[i].print_contents();
+          set_at(i).print_contents();
      }
 }
 
-void Cache::address_output(const Address &address)
+void Cache::address_output(unsigned int addr)
 {
-     if (!debug || name == "MAIN_MEMORY")
+     if (!debug || main_memory)
           return;
 
-     unsigned int tag = address.tag;
-     unsigned int index = address.setIndex;
+     unsigned int tag = decoder.tag(addr);
+     unsigned int index = decoder.setIndex(addr);
 
      std::ostringstream tag_stream;
      tag_stream << std::hex << tag;
 
      std::ostringstream address_stream;
-     address_stream << std::hex << address.blockPrefix;
+     address_stream << std::hex << decoder.blockPrefix(addr);
 
      std::cout << address_stream.str() << " ";
      std::cout << "(tag " << tag_stream.str() << ", index " << index;
 }
 
-void Cache::block_output(Block &block)
+void Cache::block_output(const Victim &victim, unsigned int setIndex)
 {
-     if (!debug || name == "MAIN_MEMORY")
+     if (!debug || main_memory)
           return;
 
-     auto& address = block.getAddress();
-     address_output(address);
+     address_output(decoder.blockAddress(victim.tag, setIndex));
 
      std::string cleanliness{};
-     if (block.isDirty())
+     if (victim.dirty)
           cleanliness = "dirty";
      else
           cleanliness = "clean";
@@ -422,37 +640,36 @@ void Cache::block_output(Block &block)
      std::cout << ", " << cleanliness << ")" << std::endl;
 }
 
-void Cache::victim_output(Block &block)
+void Cache::victim_output(const Victim &victim, unsigned int setIndex)
 {
-     if (!debug || name == "MAIN_MEMORY")
+     if (!debug || main_memory)
           return;
 
      std::cout << name << " victim: ";
-     block_output(block);
+     block_output(victim, setIndex);
 }
 
 void Cache::no_victim_output()
 {
-     if (!debug || name == "MAIN_MEMORY")
+     if (!debug || main_memory)
           return;
 
      std::cout << name << " victim: none" << std::endl;
 }
 
-void Cache::op_output(std::string op, unsigned int addr)
+void Cache::op_output(const char *op, unsigned int addr)
 {
-     if (!debug || name == "MAIN_MEMORY") 
+     if (!debug || main_memory) 
           return;
 
-     auto address = Address(addr, blocksize, numSets);
      std::cout << name << " " << op << " : ";
-     address_output(address);
+     address_output(addr);
      std::cout << ")" << std::endl;
 }
 
 void Cache::hit_output()
 {
-     if (!debug || name == "MAIN_MEMORY")
+     if (!debug || main_memory)
           return;
 
      std::cout << name << " hit" << std::endl;
@@ -461,8 +678,16 @@ void Cache::hit_output()
 
 void Cache::miss_output()
 {
-     if (!debug || name == "MAIN_MEMORY")
+     if (!debug || main_memory)
           return;
 
      std::cout << name << " miss" << std::endl;
+}
+
+void Cache::bypass_output()
+{
+     if (!debug || main_memory)
+          return;
+
+     std::cout << name << " bypass" << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "cache_slab.hpp"
+#include "host_cache_line.hpp"
+#include "policy_bits.hpp"
+#include "tag_match.hpp"
+
+// Round `bytes` up to a multiple of `alignment`, a power of two.
+static std::size_t align_up(std::size_t bytes, std::size_t alignment)
+{
+     return (bytes + alignment - 1) & ~(alignment - 1);
+}
+
+// Allocate `size` zeroed bytes aligned to a host cache line.
+static std::byte *allocate_lines(std::size_t size)
+{
+     auto *bytes = static_cast<std::byte *>(
+         ::operator new(std::max<std::size_t>(size, 1), std::align_val_t{HOST_CACHE_LINE}));
+     std::memset(bytes, 0, size);
+     return bytes;
+}
+
+void CacheSlab::AlignedDelete::operator()(std::byte *bytes) const
+{
+     ::operator delete(bytes, std::align_val_t{HOST_CACHE_LINE});
+}
+
+CacheSlab::CacheSlab(unsigned int numSets, unsigned int assoc,
+                     ReplacementPolicy replacement_policy, const std::string &cache_name,
+                     bool debug)
+    : numSets(numSets)
+{
+     std::size_t mask_bytes = mask_words(assoc) * sizeof(std::uint64_t);
+     std::size_t way_bytes = assoc * sizeof(unsigned int);
+
+     layout.assoc = assoc;
+     layout.replacement_policy = replacement_policy;
+     layout.debug = debug;
+     layout.main_memory = cache_name == "MAIN_MEMORY";
+     layout.cache_name = cache_name;
+
+     // SetState is a whole number of 64-bit words, so every mask stays 8-byte aligned.
+     layout.valid_offset = sizeof(SetState);
+     layout.dirty_offset = layout.valid_offset + mask_bytes;
+     layout.tags_offset = layout.dirty_offset + mask_bytes;
+     layout.LRU_offset = layout.tags_offset + padded_ways(assoc) * sizeof(unsigned int);
+     std::size_t LRU_bytes = (assoc > RANKED_MAX_WAYS) ? way_bytes : 0; // Else packed ranks
+     layout.FIFO_offset = layout.LRU_offset + LRU_bytes;
+     layout.next_use_offset = layout.FIFO_offset + way_bytes;
+     std::size_t next_use_bytes =
+         (replacement_policy == ReplacementPolicy::Optimal) ? way_bytes : 0;
+     layout.RRPV_offset =
+         align_up(layout.next_use_offset + next_use_bytes, sizeof(std::uint64_t));
+     std::size_t RRPV_bytes = isRRIP(replacement_policy) ? rrpv_words(assoc) * sizeof(std::uint64_t) : 0;
+     layout.stride = align_up(layout.RRPV_offset + RRPV_bytes, HOST_CACHE_LINE);
+
+     bytes.reset(allocate_lines(getBytes()));
+}
+
+CacheSlab::CacheSlab(const CacheSlab &other)
+    : numSets(other.numSets), layout(other.layout)
+{
+     if (other.bytes)
+     {
+          bytes.reset(allocate_lines(getBytes()));
+          std::memcpy(bytes.get(), other.bytes.get(), getBytes());
+     }
+}
+
+CacheSlab &CacheSlab::operator=(const CacheSlab &other)
+{
+     if (this != &other)
+     {
+          CacheSlab copy(other);
+          *this = std::move(copy);
+     }
+     return *this;
+}
+
+void CacheSlab::copySets(const CacheSlab &other, unsigned int first, unsigned int end)
+{
+     std::memcpy(bytes.get() + first * layout.stride, other.bytes.get() + first * layout.stride,
+                 static_cast<std::size_t>(end - first) * layout.stride);
+}
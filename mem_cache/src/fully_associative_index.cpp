@@ -0,0 +1,65 @@
+#include <bit>
+
+#include "fully_associative_index.hpp"
+
+#define LOAD_FACTOR 2 // Slots per way, so probe runs stay short
+
+FullyAssociativeIndex::FullyAssociativeIndex(unsigned int ways)
+    : ways(ways)
+{
+     unsigned int capacity = std::bit_ceil(ways * LOAD_FACTOR);
+     mask = capacity - 1;
+     shift = 32 - std::countr_zero(capacity);
+     slots.resize(capacity);
+     links.resize(ways + 1);
+     clear();
+}
+
+void FullyAssociativeIndex::clear()
+{
+     for (auto &slot : slots)
+          slot = Slot{0, NONE};
+     for (auto &link : links)
+          link = Link{NONE, NONE};
+     links[ways] = Link{ways, ways};
+}
+
+void FullyAssociativeIndex::insert(unsigned int tag, unsigned int way)
+{
+     unsigned int slot = home(tag);
+     while (slots[slot].way != NONE && slots[slot].tag != tag)
+          slot = (slot + 1) & mask;
+     slots[slot] = Slot{tag, way};
+}
+
+void FullyAssociativeIndex::erase(unsigned int tag)
+{
+     unsigned int slot = home(tag);
+     while (slots[slot].way != NONE && slots[slot].tag != tag)
+          slot = (slot + 1) & mask;
+     if (slots[slot].way == NONE)
+          return;
+
+     // Shift later entries of the probe run back into the hole, so no tombstones are needed.
+     unsigned int hole = slot;
+     for (unsigned int next = (hole + 1) & mask; slots[next].way != NONE; next = (next + 1) & mask)
+     {
+          unsigned int want = home(slots[next].tag);
+          if (((next - want) & mask) >= ((next - hole) & mask))
+          {
+               slots[hole] = slots[next];
+               hole = next;
+          }
+     }
+     slots[hole].way = NONE;
+}
+
+void FullyAssociativeIndex::unlink(unsigned int way)
+{
+     Link &link = links[way];
+     if (link.next == NONE)
+          return;
+     links[link.prev].next = link.next;
+     links[link.next].prev = link.prev;
+     link = Link{NONE, NONE};
+}
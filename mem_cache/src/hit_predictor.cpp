@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstring>
+
+#include "hit_predictor.hpp"
+
+#define WEAKLY_REUSED 1 // Initial counter: a signature is live until it has been seen dying
+
+HitPredictor::HitPredictor(InsertionPredictor mode, unsigned int numSets, unsigned int assoc)
+    : mode(mode), numSets(numSets), assoc(assoc),
+      table(std::size_t{1} << SIGNATURE_BITS, WEAKLY_REUSED),
+      history(static_cast<std::size_t>(numSets) * assoc)
+{
+}
+
+bool HitPredictor::fill(unsigned int setIndex, unsigned int way, unsigned int addr)
+{
+     unsigned int sig = signature(addr);
+     bool dead = table[sig] == 0;
+     history[slot(setIndex, way)] = History{static_cast<std::uint16_t>(sig), 0,
+                                              static_cast<std::uint8_t>(dead)};
+     if (dead)
+          counters.dead_fills++;
+     else
+          counters.live_fills++;
+     return dead;
+}
+
+void HitPredictor::evict(unsigned int setIndex, unsigned int way)
+{
+     const History &block = history[slot(setIndex, way)];
+     if (block.reused)
+     {
+          if (block.dead)
+               counters.dead_reused++;
+          else
+               counters.live_reused++;
+          return;
+     }
+
+     if (block.dead)
+          counters.dead_unused++;
+     else
+          counters.live_unused++;
+     if (table[block.signature] > 0)
+          table[block.signature]--;
+}
+
+double HitPredictor::accuracy() const
+{
+     std::uint64_t correct = counters.dead_unused + counters.live_reused;
+     std::uint64_t evicted = correct + counters.dead_reused + counters.live_unused;
+     return (evicted == 0) ? 0.0 : static_cast<double>(correct) / evicted;
+}
+
+void HitPredictor::merge(const HitPredictor &other, unsigned int first, unsigned int end)
+{
+     counters.dead_fills += other.counters.dead_fills;
+     counters.live_fills += other.counters.live_fills;
+     counters.bypasses += other.counters.bypasses;
+     counters.dead_unused += other.counters.dead_unused;
+     counters.dead_reused += other.counters.dead_reused;
+     counters.live_reused += other.counters.live_reused;
+     counters.live_unused += other.counters.live_unused;
+
+     std::copy(other.history.begin() + slot(first, 0), other.history.begin() + slot(end, 0),
+               history.begin() + slot(first, 0));
+
+     // The table is shared by all sets, so it only carries over with all of them.
+     if (first == 0 && end == numSets)
+     {
+          table = other.table;
+          dead_misses = other.dead_misses;
+     }
+}
+
+std::size_t HitPredictor::savedBytes() const
+{
+     if (!enabled())
+          return 0;
+     return sizeof(counters) + sizeof(dead_misses) + table.size() +
+            history.size() * sizeof(History);
+}
+
+std::vector<unsigned char> HitPredictor::save() const
+{
+     std::vector<unsigned char> bytes(savedBytes());
+     if (bytes.empty())
+          return bytes;
+
+     unsigned char *cursor = bytes.data();
+     std::memcpy(cursor, &counters, sizeof(counters));
+     cursor += sizeof(counters);
+     std::memcpy(cursor, &dead_misses, sizeof(dead_misses));
+     cursor += sizeof(dead_misses);
+     std::memcpy(cursor, table.data(), table.size());
+     cursor += table.size();
+     std::memcpy(cursor, history.data(), history.size() * sizeof(History));
+     return bytes;
+}
+
+void HitPredictor::restore(std::span<const unsigned char> bytes)
+{
+     if (bytes.empty())
+          return;
+
+     const unsigned char *cursor = bytes.data();
+     std::memcpy(&counters, cursor, sizeof(counters));
+     cursor += sizeof(counters);
+     std::memcpy(&dead_misses, cursor, sizeof(dead_misses));
+     cursor += sizeof(dead_misses);
+     std::memcpy(table.data(), cursor, table.size());
+     cursor += table.size();
+     std::memcpy(history.data(), cursor, history.size() * sizeof(History));
+}
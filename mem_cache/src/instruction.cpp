@@ -5,7 +5,7 @@
 
 // Constructor implementation
 Instruction::Instruction(unsigned short op, unsigned int address)
-    : op(op), address(address) {}
+    : address(address), op(static_cast<unsigned char>(op)) {}
 
 std::string Instruction::to_string() const
 {
@@ -2,27 +2,26 @@
 #include <iomanip>
 #include <string>
 
-#include "address.hpp"
+#include "address_decoder.hpp"
 #include "block.hpp"
 #include "replacement_policy.hpp"
 #include "output.hpp"
 
-void Output::address_output(const Address &address)
+void Output::address_output(unsigned int addr)
 {
-     unsigned int index = address.setIndex;
+     unsigned int index = decoder.setIndex(addr);
 
      std::stringstream stream;
-     stream << std::hex << address.tag;
+     stream << std::hex << decoder.tag(addr);
      std::string tag(stream.str());
 
-     std::cout << std::hex << address.value << " ";
+     std::cout << std::hex << addr << " ";
      std::cout << "(tag " << tag << ", index " << index;
 }
 
-void Output::block_output(Block &block)
+void Output::block_output(Block &block, unsigned int setIndex)
 {
-     auto &address = block.getAddress();
-     address_output(address);
+     address_output(decoder.blockAddress(block.getTag(), setIndex));
 
      std::string cleanliness{};
      if (block.isDirty())
@@ -33,13 +32,13 @@ void Output::block_output(Block &block)
      std::cout << ", " << cleanliness << ")" << std::endl;
 }
 
-void Output::victim_output(Block &block)
+void Output::victim_output(Block &block, unsigned int setIndex)
 {
      if (!debug)
           return;
 
      std::cout << name << " victim: ";
-     block_output(block);
+     block_output(block, setIndex);
 }
 
 void Output::op_output(const std::string &op, unsigned int addr)
@@ -47,9 +46,8 @@ void Output::op_output(const std::string &op, unsigned int addr)
      if (!debug)
           return;
 
-     auto address = Address(addr, blocksize, numSets);
      std::cout << name << " " << op << " : ";
-     address_output(address);
+     address_output(addr);
      std::cout << ")" << std::endl;
 }
 
@@ -81,6 +79,11 @@ void Output::update_policy_output()
           case ReplacementPolicy::LRU: policy = "LRU"; break;
           case ReplacementPolicy::FIFO: policy = "FIFO"; break;
           case ReplacementPolicy::Optimal: policy = "optimal"; break;
+          case ReplacementPolicy::TreePLRU: policy = "tree-PLRU"; break;
+          case ReplacementPolicy::BitPLRU: policy = "bit-PLRU"; break;
+          case ReplacementPolicy::SRRIP: policy = "SRRIP"; break;
+          case ReplacementPolicy::BRRIP: policy = "BRRIP"; break;
+          case ReplacementPolicy::DRRIP: policy = "DRRIP"; break;
      }
 
      std::cout << policy << std::endl;
@@ -1,354 +1,134 @@
 #include <algorithm>
+#include <bit>
 #include <iostream>
 #include <iomanip>
 #include <optional>
-#include <vector>
 #include <climits>
+#include <vector>
 
 #include "inclusion_property.hpp"
 #include "replacement_policy.hpp"
 
-#include "address.hpp"
 #include "block.hpp"
 #include "set.hpp"
 #include "output.hpp"
+#include "tag_match.hpp"
 
-#define DIRECT_MAPPED 1
-#define ONLY_BLOCK 0
-#define FIRST_OF_REMAINING 0
-#define MISS std::nullopt
-#define EMPTY_BLOCK std::nullopt
-#define HIT std::nullopt
-#define NOT_FOUND UINT_MAX
-
-Set::Set(unsigned int assoc, unsigned int blocksize, ReplacementPolicy replacement_policy,
-         const std::string cache_name, bool debug)
-    : assoc(assoc), blocksize(blocksize), replacement_policy(replacement_policy),
-      LRU_counters(assoc), debug(debug), cache_name(cache_name), LRU(0)
+Set::Set(const SetLayout &layout, std::byte *record, unsigned int set_index,
+         std::optional<SetTrace> trace, FullyAssociativeIndex *index, SetDueling *dueling)
+    : layout(&layout), record(record), trace(trace), index(index), dueling(dueling),
+      set_index(set_index)
 {
-     size = 0;
-     capacity = assoc;
-
-     // Initialize first insertion position.
-     open_block = 0;
-     trace_idx = 0;
-
-     blocks.reserve(assoc);
 }
 
-void Set::initialize(const Address &addr)
+Block Set::block(unsigned int way) const
 {
-     for (unsigned int i = 0; i < assoc; ++i)
-     {
-          blocks.emplace_back(Block(blocksize, addr));
-          blocks[i].clear();
-     }
-}
-
-std::optional<std::reference_wrapper<Block>> Set::read(const Address &addr)
-{
-     return search(addr);
+     Block block(tags()[way]);
+     if (!(valid_bits()[word_of(way)] & bit_of(way)))
+          block.clear();
+     if (dirty_bits()[word_of(way)] & bit_of(way))
+          block.setDirty();
+     return block;
 }
 
-std::optional<std::reference_wrapper<Block>> Set::write(const Block &block)
+void Set::stamp_next_use(unsigned int way)
 {
-     auto& addr = block.getAddress();
-     return write(addr);
+     if (trace)
+          next_uses()[way] = trace->first_use(tags()[way], state().trace_idx);
 }
 
-std::optional<std::reference_wrapper<Block>> Set::allocate(const Address &addr)
+void Set::remove_FIFO(unsigned int way)
 {
-     // If the set is not yet full, fill an empty block.
-     if (!isFull())
-     {
-          // Create new block.
-          Block block = Block(blocksize, addr);
-          fillBlock(block);
-          return EMPTY_BLOCK; // No victim
-     }
-
-     // Otherwise, determine victim block index.
-     unsigned int victim_idx;
-     switch (replacement_policy)
+     // Close the gap left by `way`, keeping the others in fill order.
+     SetState &s = state();
+     unsigned int *ring = FIFO_order();
+     unsigned int kept = 0;
+     for (unsigned int i = 0; i < s.FIFO_count; i++)
      {
-          case ReplacementPolicy::LRU:
-               victim_idx = get_LRU_replacement();
-               update_LRU(victim_idx);
-               break;
-
-          case ReplacementPolicy::FIFO:
-               victim_idx = get_FIFO_replacement();
-               break;
-
-          case ReplacementPolicy::Optimal:
-               victim_idx = get_optimal_replacement();
-               break;
+          unsigned int entry = ring[(s.FIFO_head + i) % layout->assoc];
+          if (entry != way)
+               ring[(s.FIFO_head + kept++) % layout->assoc] = entry;
      }
-
-     // Get victim block.
-     Block victim_block = blocks[victim_idx];
-
-     // Replace victim block.
-     Block block = Block(blocksize, addr);
-     blocks[victim_idx] = block;
-
-     // Add data.
-     // { Get data arg. Do something. Need tag. }
-
-     Block &victim_ref = victim_block;
-     return victim_ref;
+     s.FIFO_count = kept;
 }
 
-std::optional<std::reference_wrapper<Block>> Set::write(const Address &addr)
+void Set::delete_block(unsigned int tag)
 {
-     auto hit = search(addr);
-     if (hit)
+     unsigned int way = find(tag);
+     if (way < layout->assoc)
      {
-          // Add data.
-          // { Get data arg. Do something. Need tag. }
-
-          Block &block = hit->get();
-          block.setDirty();
-          // dirty_output();
-
-          // Update replacement policy.
-          if (replacement_policy == ReplacementPolicy::LRU)
+          valid_bits()[word_of(way)] &= ~bit_of(way);
+          dirty_bits()[word_of(way)] &= ~bit_of(way);
+          remove_FIFO(way);
+          state().size--;
+          if (index != nullptr)
           {
-               unsigned int idx = getIdx(addr);
-               update_LRU(idx);
+               index->erase(tag);
+               index->unlink(way);
           }
-          return HIT; // No victim
-     }
-
-     // If the set is not yet full, fill an empty block.
-     if (!isFull())
-     {
-          // Create new block.
-          Block block = Block(blocksize, addr);
-          block.setDirty();
-          // dirty_output();
-          fillBlock(block);
-          return EMPTY_BLOCK; // No victim
-     }
-
-     // Otherwise, determine victim block index.
-     unsigned int victim_idx;
-     switch (replacement_policy)
-     {
-          case ReplacementPolicy::LRU:
-               victim_idx = get_LRU_replacement();
-               update_LRU(victim_idx);
-               break;
-
-          case ReplacementPolicy::FIFO:
-               victim_idx = get_FIFO_replacement(); break;
-
-          case ReplacementPolicy::Optimal:
-               victim_idx = get_optimal_replacement(); break;
-     }
-
-     // Get victim block.
-     Block victim_block = blocks[victim_idx];
-
-     // Replace victim block.
-     Block block = Block(blocksize, addr);
-     blocks[victim_idx] = block;
-
-     // Add data.
-     // { Get data arg. Do something. Need tag. }
-
-     blocks[victim_idx].setDirty();
-     // dirty_output();
-
-     Block &victim_ref = victim_block;
-     return victim_ref;
-}
-
-std::optional<std::reference_wrapper<Block>> Set::search(const Address &addr)
-{
-     for (auto& block : blocks)
-     {
-          if (addr.tag == block.getAddress().tag && !block.isAvailable())
-               return block;
-     }
-
-     return MISS;
-}
-
-unsigned int Set::getIdx(const Address &addr) const
-{
-     for (int i = 0; i < assoc; i++)
-     {
-          if (addr.tag == blocks[i].getAddress().tag)
-               return i;
      }
-
-     return NOT_FOUND;
 }
 
-void Set::delete_block(const Address &addr)
+void Set::restamp_next_uses()
 {
-     auto result = search(addr);
-     if (result)
-     {
-          Block& block = result->get();
-          block.unsetDirty();
-          block.clear();
-          size--;
-     }
+     for (unsigned int way = 0; way < layout->assoc; way++)
+          stamp_next_use(way);
 }
 
-void Set::fillBlock(const Block &block)
+void Set::rebuild_index()
 {
-     // Add data.
-     // { Get data arg. Do something }
+     index->clear();
 
-     for (int i = 0; i < assoc; i++)
+     // Valid ways by tag, then every way in stamp order, as update_LRU would have listed them.
+     std::vector<unsigned int> order;
+     for (unsigned int way = 0; way < layout->assoc; way++)
      {
-          if (blocks[i].isAvailable())
+          if (valid_bits()[word_of(way)] & bit_of(way))
           {
-               open_block = i;
-               break;
+               index->insert(tags()[way], way);
+               order.push_back(way);
           }
      }
-
-     // Update replacement policy.
-     FIFO_indices.push(open_block);
-     update_LRU(open_block);
-
-     // Otherwise, insert block at the current open position and look for other open spot.
-     blocks[open_block] = block;
-     blocks[open_block].occupy();
-     size++;
-
+     const unsigned int *counters = LRU_counters();
+     std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+                      { return counters[a] < counters[b]; });
+     for (unsigned int way : order)
+          index->touch(way);
 }
 
-Block Set::replaceBlock_FIFO(const Address &addr)
+Victim Set::replaceBlock_FIFO(unsigned int tag)
 {
      // Determine victim block.
      unsigned int victim_idx = get_FIFO_replacement();
-     Block victim_block = blocks[victim_idx];
 
      // Replace victim block.
-     Block block = Block(blocksize, addr);
-     blocks[victim_idx] = block;
-
      // Add data.
      // { Get data arg. Do something. Need tag. }
 
-     return victim_block;
-}
-
-unsigned int Set::get_LRU_replacement()
-{
-     // Direct mapped cache always replaces the same block.
-     if (assoc == DIRECT_MAPPED)
-          return ONLY_BLOCK;
-
-     // Get iterator to the minimum element
-     auto minIt = std::min_element(LRU_counters.begin(), LRU_counters.end());
-
-     // Calculate the index from the iterator
-     unsigned int victim_idx = std::distance(LRU_counters.begin(), minIt);
-
-     return victim_idx;
-}
-
-void Set::update_LRU(unsigned int idx)
-{
-     LRU_counters[idx] = LRU;
-     LRU++;
-     update_policy_output();
-}
-
-unsigned int Set::get_FIFO_replacement()
-{
-     update_policy_output();
-
-     // Direct mapped cache always replaces the same block.
-     if (assoc == DIRECT_MAPPED)
-          return ONLY_BLOCK;
-
-     unsigned int victim_idx = FIFO_indices.front();
-     FIFO_indices.pop();
-     FIFO_indices.push(victim_idx);
-     return victim_idx;
-}
-
-unsigned int Set::get_optimal_replacement()
-{
-     update_policy_output();
-
-     // Direct mapped cache always replaces the same block.
-     if (assoc == DIRECT_MAPPED)
-          return ONLY_BLOCK;
-
-     // Create vector of yet to be used blocks' indices.
-     std::vector<unsigned int> unused_block_indices;
-     for (int i = 0; i < assoc; i++)
-          unused_block_indices.push_back(i);
-
-     // Track usage of blocks in set trace until one block in set is unused.
-     unsigned int trace_address_block;
-     unsigned int search_idx = trace_idx;
-     while (search_idx < trace.size())
-     {
-          // Mark any blocks which match the current trace address as used.
-          trace_address_block = trace[search_idx].blockPrefix;
-          mark_used(trace_address_block, unused_block_indices);
-          search_idx++;
-
-          // for (auto idx : unused_block_indices)
-          // {
-          //      std::cout << "Unused " << idx << ": ";
-          //      std::cout << blocks[idx].getAddress() << std::endl;
-          // }
-          // std::cout << std::endl;
-
-          // If we've removed all but one block from our list of unused,
-          // the only block left is either last to be reused or never used at all.
-          if (unused_block_indices.size() == 1) return unused_block_indices[ONLY_BLOCK];
-     }
-
-     // If we reach this line, there is a tie for unused blocks. Return the first of them.
-     return unused_block_indices[FIRST_OF_REMAINING];
-}
-
-void Set::mark_used(unsigned int trace_address_block, std::vector<unsigned int> &indices)
-{
-     // Check each block in our unused blocks list to see if it matches the current trace.
-     for (unsigned int index : indices)
-     {
-
-          // Each time a trace address matches an item in our list of unused blocks,
-          // mark that block as used (i.e. remove from list of unused).
-          if (blocks[index].getAddress().blockPrefix == trace_address_block)
-          {
-               // Removes unique cell containing "index" from indices vector.
-               auto it = std::find(indices.begin(), indices.end(), index);
-               if (it != indices.end()) indices.erase(it);
-          }
-     }
+     return replace<DYNAMIC_WAYS>(victim_idx, tag, false);
 }
 
 void Set::print_trace()
 {
-     for (int i = 0; i < trace.size(); i++)
+     if (!trace)
+          return;
+
+     for (std::size_t i = 0; i < trace->size(); i++)
      {
-          Address& address = trace[i];
-          std::cout << "Address " << i << ": " << address << std::endl;
-          std::cout << "Block " << i << ": ";
-          std::cout << address.blockToString() << std::endl << std::endl;;
+          std::cout << "Tag " << i << ": " << std::hex << (*trace)[i] << std::dec;
+          std::cout << std::endl << std::endl;
      }
 }
 
 void Set::print_contents()
 {
-     for (auto& block : blocks) 
+     for (unsigned int way = 0; way < layout->assoc; way++)
      {
+          Block block = this->block(way);
+
           // Get tag as hexidecimal string.
           std::stringstream stream;
-          stream << std::hex << block.getAddress().tag;
+          stream << std::hex << block.getTag();
           std::string tag(stream.str());
 
           // Construct dirty bit string.
@@ -362,18 +142,20 @@ void Set::print_contents()
      std::cout << std::endl;
 }
 
-void Set::update_policy_output()
+void Set::policy_output()
 {
-     if (!debug || cache_name == "MAIN_MEMORY")
-          return;
-
-     std::cout << cache_name << " update ";
+     std::cout << layout->cache_name << " update ";
      std::string policy;
-     switch(replacement_policy)
+     switch(layout->replacement_policy)
      {
           case ReplacementPolicy::LRU: policy = "LRU"; break;
           case ReplacementPolicy::FIFO: policy = "FIFO"; break;
           case ReplacementPolicy::Optimal: policy = "optimal"; break;
+          case ReplacementPolicy::TreePLRU: policy = "tree-PLRU"; break;
+          case ReplacementPolicy::BitPLRU: policy = "bit-PLRU"; break;
+          case ReplacementPolicy::SRRIP: policy = "SRRIP"; break;
+          case ReplacementPolicy::BRRIP: policy = "BRRIP"; break;
+          case ReplacementPolicy::DRRIP: policy = "DRRIP"; break;
      }
 
      std::cout << policy << std::endl;
@@ -381,10 +163,8 @@ void Set::update_policy_output()
 
 void Set::dirty_output()
 {
-     if (!debug || cache_name == "MAIN_MEMORY")
+     if (!layout->debug || layout->main_memory)
           return;
 
-     std::cout << cache_name << " set dirty" << std::endl;
+     std::cout << layout->cache_name << " set dirty" << std::endl;
 }
-
-
@@ -0,0 +1,16 @@
+#include <algorithm>
+
+#include "set_dueling.hpp"
+
+#define SETS_PER_LEADER_PAIR 4 // At least half of the sets are followers
+
+SetDueling::SetDueling(unsigned int numSets, unsigned int leaders, unsigned int psel_bits)
+    : psel_max((1u << psel_bits) - 1)
+{
+     // Both counts are powers of two, so every run holds the same number of sets.
+     leaders = std::min(leaders, numSets / SETS_PER_LEADER_PAIR);
+     constituency = (leaders == 0) ? 0 : numSets / leaders;
+
+     // Start at the midpoint, where followers use A.
+     psel = psel_max / 2;
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+#include "set_trace.hpp"
+
+SetTraces::SetTraces(std::span<const Instruction> trace, const AddressDecoder &decoder,
+                     unsigned int numSets)
+    : trace(trace), decoder(decoder), offsets(numSets + 1, 0), positions(trace.size()),
+      next(trace.size(), NEVER), by_tag(trace.size())
+{
+     // Count the accesses of each set, then place each position after its set's earlier ones.
+     for (const auto &instruction : trace)
+          offsets[decoder.setIndex(instruction.address) + 1]++;
+     std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+     // Tags are gathered alongside, so the sorts below read them in order.
+     std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+     std::vector<unsigned int> grouped_tags(trace.size());
+     for (unsigned int position = 0; position < trace.size(); position++)
+     {
+          unsigned int address = trace[position].address;
+          unsigned int slot = fill[decoder.setIndex(address)]++;
+          positions[slot] = position;
+          grouped_tags[slot] = decoder.tag(address);
+     }
+
+     // Sort each set's accesses by (tag, index), packed into one key so the sort compares
+     // plain integers.
+     std::vector<std::uint64_t> keys;
+     for (unsigned int set = 0; set < numSets; set++)
+     {
+          unsigned int size = offsets[set + 1] - offsets[set];
+          const unsigned int *local = grouped_tags.data() + offsets[set];
+
+          keys.resize(size);
+          for (unsigned int index = 0; index < size; index++)
+               keys[index] = (std::uint64_t{local[index]} << 32) | index;
+          std::sort(keys.begin(), keys.end());
+
+          // Consecutive accesses to one tag are adjacent in the order, which yields the links.
+          unsigned int *order = by_tag.data() + offsets[set];
+          unsigned int *links = next.data() + offsets[set];
+          for (unsigned int k = 0; k < size; k++)
+          {
+               order[k] = static_cast<unsigned int>(keys[k]);
+               if (k + 1 < size && (keys[k] >> 32) == (keys[k + 1] >> 32))
+                    links[order[k]] = static_cast<unsigned int>(keys[k + 1]);
+          }
+     }
+}
+
+unsigned int SetTrace::first_use(unsigned int tag, unsigned int from) const
+{
+     auto first = traces->by_tag.begin() + begin;
+     auto last = traces->by_tag.begin() + end;
+     auto it = std::lower_bound(first, last, from,
+                                [&](unsigned int index, unsigned int)
+                                {
+                                     unsigned int other = (*this)[index];
+                                     return other < tag || (other == tag && index < from);
+                                });
+     if (it == last || (*this)[*it] != tag)
+          return NEVER;
+
+     return *it;
+}
@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "memory_access.hpp"
+
+#include "cache.hpp"
+#include "stack_distance.hpp"
+
+#define FREE UINT_MAX
+#define NEVER UINT_MAX
+#define MIN_CAPACITY 4
+#define MIN_SAMPLED_SETS 32
+#define MIN_SAMPLED_DEPTH 8
+
+// Fenwick tree helpers over 1-based times.
+static unsigned int prefix(const std::vector<unsigned int> &tree, unsigned int time)
+{
+     unsigned int sum = 0;
+     for (; time > 0; time &= time - 1)
+          sum += tree[time];
+     return sum;
+}
+
+static void adjust(std::vector<unsigned int> &tree, unsigned int time, int delta)
+{
+     for (; time < tree.size(); time += time & -time)
+          tree[time] += delta;
+}
+
+// The earliest marked time, found by descending the tree.
+static unsigned int first_mark(const std::vector<unsigned int> &tree)
+{
+     unsigned int time = 0;
+     for (unsigned int step = std::bit_floor(tree.size() - 1); step > 0; step >>= 1)
+          if (time + step < tree.size() && tree[time + step] == 0)
+               time += step;
+     return time + 1;
+}
+
+// Two-sided 95% quantiles of Student's t, by degrees of freedom from 1.
+static const double T_95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                              2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131};
+#define Z_95 1.960
+
+static_assert(sizeof(T_95) / sizeof(T_95[0]) >= StackDistance::GROUPS - 1,
+              "Need a t quantile for every group count");
+
+// Spreads keys uniformly over 64 bits (the splitmix64 finalizer). The low bits are compared
+// against a threshold and the high bits pick the group.
+static std::uint64_t mix(std::uint64_t x)
+{
+     x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+     x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+     return x ^ (x >> 31);
+}
+
+StackDistance::StackDistance(unsigned int blocksize, unsigned int min_size,
+                             unsigned int max_size, SweepSampling sampling)
+    : blocksize(blocksize), min_size(min_size), max_size(max_size)
+{
+     if (!std::has_single_bit(blocksize) || !std::has_single_bit(min_size) ||
+         !std::has_single_bit(max_size))
+          throw std::invalid_argument("block size and cache sizes must be powers of two");
+     if (blocksize > min_size || min_size > max_size)
+          throw std::invalid_argument("cache sizes must satisfy BLOCKSIZE <= MIN <= MAX");
+     if (!(sampling.rate > 0.0 && sampling.rate <= 1.0))
+          throw std::invalid_argument("sampling rate must be in (0, 1]");
+
+     std::uint64_t threshold = std::llround(sampling.rate * MODULUS);
+     if (threshold == 0)
+          throw std::invalid_argument("sampling rate is below 1 / " + std::to_string(MODULUS));
+
+     decoder = AddressDecoder(blocksize, 1);
+     sampled = threshold < MODULUS || sampling.budget != 0;
+
+     // From fully associative (one set) to direct mapped at the largest size.
+     unsigned int min_blocks = min_size / blocksize;
+     unsigned int max_blocks = max_size / blocksize;
+     for (unsigned int numSets = 1; numSets <= max_blocks && numSets != 0; numSets *= 2)
+     {
+          Level level;
+          level.numSets = numSets;
+          level.max_assoc = max_blocks / numSets;
+
+          // Scaled distances are only as fine as 1 / rate, so blocks are sampled only where
+          // every associativity reported is well above that. Elsewhere whole sets are, at
+          // least enough of them to hold a sample.
+          unsigned int min_assoc = std::max(1u, min_blocks / numSets);
+          level.by_set = min_assoc * sampling.rate < MIN_SAMPLED_DEPTH;
+          level.threshold = threshold;
+          level.floor = std::llround(double{MIN_SAMPLED_DEPTH} / min_assoc * MODULUS);
+          if (level.by_set)
+          {
+               double rate = std::max(sampling.rate, double{MIN_SAMPLED_SETS} / numSets);
+               level.threshold = std::min<std::uint64_t>(MODULUS, std::llround(rate * MODULUS));
+               level.floor = 0;
+          }
+
+          level.sets.resize(numSets);
+          level.read_hist.assign((sampled ? GROUPS : 1) * (level.max_assoc + 1), 0.0);
+          level.write_hist.assign((sampled ? GROUPS : 1) * (level.max_assoc + 1), 0.0);
+          levels.push_back(std::move(level));
+     }
+
+     // The budget is shared evenly, so every set count keeps a sample.
+     level_budget = 0;
+     if (sampling.budget != 0)
+          level_budget = std::max<std::size_t>(1, sampling.budget / levels.size());
+}
+
+void StackDistance::add(std::span<const Instruction> chunk)
+{
+     for (const auto &instruction : chunk)
+          access(instruction);
+}
+
+void StackDistance::access(const Instruction &instruction)
+{
+     bool write = instruction.op == MemoryAccess::Write;
+     if (write)
+          writes++;
+     else
+          reads++;
+
+     unsigned int block_prefix = decoder.blockPrefix(instruction.address);
+     unsigned int block = block_prefix >> decoder.getOffsetLength();
+     std::uint64_t block_hash = sampled ? mix(block_prefix) : 0;
+     unsigned int slot = FREE;
+     for (unsigned int k = 0; k < levels.size(); k++)
+     {
+          Level &level = levels[k];
+          unsigned int setIndex = block & (level.numSets - 1);
+
+          std::uint64_t hash = block_hash;
+          if (sampled && level.by_set)
+               hash = mix((std::uint64_t{k} << 32) | setIndex);
+          if ((hash & (MODULUS - 1)) >= level.threshold)
+               continue;
+
+          if (slot == FREE)
+               slot = slot_of(block_prefix);
+
+          // Newly tracked here, so it needs a place in the budget.
+          SetClock &set = level.sets[setIndex];
+          if (last[slot * levels.size() + k] == 0)
+          {
+               refs[slot]++;
+               level.live++;
+               if (level_budget != 0 && !level.by_set)
+                    level.keys.emplace(hash & (MODULUS - 1), block_prefix);
+               else if (level_budget != 0 && set.live == 0)
+                    level.keys.emplace(hash & (MODULUS - 1), setIndex);
+          }
+
+          // A first use misses everywhere, like any distance past the largest cache.
+          unsigned int d = distance(set, k, slot);
+          double weight = static_cast<double>(MODULUS) / level.threshold;
+          double scale = level.by_set ? 1.0 : weight;
+          unsigned int bucket = level.max_assoc;
+          if (d != NEVER)
+               bucket = static_cast<unsigned int>(std::min<double>(d * scale, level.max_assoc));
+
+          unsigned int group = sampled ? (hash >> 32) % GROUPS : 0;
+          std::vector<double> &hist = write ? level.write_hist : level.read_hist;
+          hist[group * (level.max_assoc + 1) + bucket] += weight;
+          level.samples++;
+
+          // Blocks that deep miss in every cache here whatever happens next, so a sample need
+          // not keep them: its stacks, and so its memory, are bounded by the geometry.
+          if (!sampled)
+               continue;
+          unsigned int depth = level.max_assoc;
+          if (!level.by_set)
+               depth = static_cast<unsigned int>(std::ceil(level.max_assoc / weight));
+          while (set.live > std::max(depth, 1u))
+               forget(k, set.owner[first_mark(set.tree) - 1]);
+     }
+
+     // Shrinking may forget this very block, so it waits until every level has seen it.
+     if (level_budget != 0)
+          for (unsigned int k = 0; k < levels.size(); k++)
+               if (levels[k].live > level_budget)
+                    shrink(k);
+}
+
+unsigned int StackDistance::slot_of(unsigned int block_prefix)
+{
+     auto [it, inserted] = slots.try_emplace(block_prefix, 0);
+     if (!inserted)
+          return it->second;
+
+     if (free_slots.empty())
+     {
+          it->second = static_cast<unsigned int>(prefixes.size());
+          prefixes.push_back(block_prefix);
+          refs.push_back(0);
+          last.resize(last.size() + levels.size(), 0);
+     }
+     else
+     {
+          it->second = free_slots.back();
+          free_slots.pop_back();
+          prefixes[it->second] = block_prefix;
+     }
+     return it->second;
+}
+
+unsigned int StackDistance::distance(SetClock &set, unsigned int level, unsigned int slot)
+{
+     // Count the blocks used since this one, then move its mark to a new time.
+     unsigned int &time = last[slot * levels.size() + level];
+     unsigned int d = NEVER;
+     if (time != 0)
+     {
+          d = set.live - prefix(set.tree, time);
+          adjust(set.tree, time, -1);
+          set.owner[time - 1] = FREE;
+          set.live--;
+     }
+
+     if (set.now + 1 >= set.tree.size())
+          rebuild(set, level);
+
+     set.now++;
+     adjust(set.tree, set.now, +1);
+     set.owner[set.now - 1] = slot;
+     set.live++;
+     time = set.now;
+     return d;
+}
+
+void StackDistance::rebuild(SetClock &set, unsigned int level)
+{
+     // Renumber the marked times 1..live in order, at twice the room they need, so rebuilds
+     // are paid for by the accesses that fill the free half and memory follows the live blocks.
+     unsigned int capacity = std::max<unsigned int>(MIN_CAPACITY, std::bit_ceil(set.live * 2));
+     std::vector<unsigned int> owner(capacity, FREE);
+     unsigned int now = 0;
+     for (unsigned int slot : set.owner)
+     {
+          if (slot == FREE)
+               continue;
+          owner[now++] = slot;
+          last[slot * levels.size() + level] = now;
+     }
+
+     // Linear-time Fenwick build: push each node's sum up to its parent.
+     set.tree.assign(capacity + 1, 0);
+     for (unsigned int time = 1; time <= now; time++)
+          set.tree[time] = 1;
+     for (unsigned int time = 1; time <= capacity; time++)
+     {
+          unsigned int parent = time + (time & -time);
+          if (parent <= capacity)
+               set.tree[parent] += set.tree[time];
+     }
+
+     set.owner = std::move(owner);
+     set.now = now;
+}
+
+void StackDistance::forget(unsigned int level, unsigned int slot)
+{
+     Level &at = levels[level];
+     unsigned int block = prefixes[slot] >> decoder.getOffsetLength();
+     SetClock &set = at.sets[block & (at.numSets - 1)];
+
+     unsigned int &time = last[slot * levels.size() + level];
+     adjust(set.tree, time, -1);
+     set.owner[time - 1] = FREE;
+     set.live--;
+     time = 0;
+     at.live--;
+     if (level_budget != 0 && !at.by_set)
+          at.keys.erase({mix(prefixes[slot]) & (MODULUS - 1), prefixes[slot]});
+
+     // Blocks no level tracks give up their slot.
+     if (--refs[slot] == 0)
+     {
+          slots.erase(prefixes[slot]);
+          free_slots.push_back(slot);
+     }
+}
+
+void StackDistance::shrink(unsigned int level)
+{
+     // The budget gives way before a sample gets too coarse: set counts keep enough sets, and
+     // block rates stay fine enough for the associativities reported.
+     Level &at = levels[level];
+     std::size_t min_keys = at.by_set ? MIN_SAMPLED_SETS : 1;
+     while (at.live > level_budget && at.keys.size() > min_keys &&
+            at.keys.rbegin()->first >= at.floor)
+     {
+          at.threshold = at.keys.rbegin()->first;
+          while (!at.keys.empty() && at.keys.rbegin()->first >= at.threshold)
+          {
+               unsigned int key = at.keys.rbegin()->second;
+               at.keys.erase(std::prev(at.keys.end()));
+               if (!at.by_set)
+               {
+                    forget(level, slots.at(key));
+                    continue;
+               }
+
+               const std::vector<unsigned int> &owner = at.sets[key].owner;
+               for (std::size_t time = 0; time < owner.size(); time++)
+                    if (owner[time] != FREE)
+                         forget(level, owner[time]);
+          }
+     }
+}
+
+StackDistance::Tally StackDistance::tally(const Level &level, unsigned int assoc,
+                                          unsigned int first_group,
+                                          unsigned int end_group) const
+{
+     // Each weight stands for the accesses it was sampled from, so accesses and misses are
+     // weighed alike even when budgets lowered the threshold part way through.
+     auto count = [&](const std::vector<double> &hist, double &accesses, double &missed)
+     {
+          for (unsigned int group = first_group; group < end_group; group++)
+          {
+               const double *buckets = hist.data() + group * (level.max_assoc + 1);
+               for (unsigned int d = 0; d <= level.max_assoc; d++)
+               {
+                    accesses += buckets[d];
+                    if (d >= assoc)
+                         missed += buckets[d];
+               }
+          }
+     };
+
+     Tally tally;
+     count(level.read_hist, tally.reads, tally.read_misses);
+     count(level.write_hist, tally.writes, tally.write_misses);
+     return tally;
+}
+
+std::pair<double, double> StackDistance::misses(const Tally &tally) const
+{
+     auto scaled = [](double missed, double accesses, std::uint64_t total)
+     {
+          return accesses > 0.0 ? missed / accesses * total : 0.0;
+     };
+     return {scaled(tally.read_misses, tally.reads, reads),
+             scaled(tally.write_misses, tally.writes, writes)};
+}
+
+StackDistance::Result StackDistance::result(unsigned int size, unsigned int assoc,
+                                            std::pair<double, double> misses) const
+{
+     // The trace's own access counts, which the misses were scaled to. Exact runs stay whole.
+     auto count = [](double weight, std::uint64_t limit)
+     {
+          return static_cast<unsigned int>(
+              std::min<double>(std::llround(std::max(weight, 0.0)), limit));
+     };
+
+     Result result;
+     result.size = size;
+     result.assoc = assoc;
+     result.reads = static_cast<unsigned int>(reads);
+     result.read_misses = count(misses.first, reads);
+     result.writes = static_cast<unsigned int>(writes);
+     result.write_misses = count(misses.second, writes);
+     result.miss_rate = Cache::miss_rate_of(result.reads, result.read_misses, result.writes,
+                                            result.write_misses);
+     result.error = 0.0;
+     return result;
+}
+
+std::vector<StackDistance::Result> StackDistance::results() const
+{
+     std::vector<Result> results;
+     for (unsigned int size = min_size; size <= max_size && size != 0; size *= 2)
+     {
+          unsigned int blocks = size / blocksize;
+          for (unsigned int assoc = 1; assoc <= blocks; assoc *= 2)
+          {
+               // The caches with this many sets hit exactly the accesses at distance < assoc.
+               const Level &level = levels[std::countr_zero(blocks / assoc)];
+               unsigned int groups = level.read_hist.size() / (level.max_assoc + 1);
+               results.push_back(result(size, assoc, misses(tally(level, assoc, 0, groups))));
+               if (level.threshold != MODULUS)
+                    results.back().error = error(level, size, assoc, results.back());
+          }
+     }
+     return results;
+}
+
+double StackDistance::error(const Level &level, unsigned int size, unsigned int assoc,
+                            const Result &estimate) const
+{
+     // Each group that sampled both kinds of access the trace has estimates the same miss
+     // rate from its part of the sample, so their spread over the square root of their
+     // number is the standard error of the whole sample's estimate.
+     double rates[GROUPS];
+     unsigned int estimates = 0;
+     for (unsigned int group = 0; group < GROUPS; group++)
+     {
+          Tally part = tally(level, assoc, group, group + 1);
+          if ((reads > 0 && part.reads == 0.0) || (writes > 0 && part.writes == 0.0))
+               continue;
+          rates[estimates++] = result(size, assoc, misses(part)).miss_rate;
+     }
+
+     // Without two estimates there is no spread to go by, and nothing is claimed.
+     if (estimates < 2 || level.samples == 0)
+          return 1.0;
+
+     // The sampled references are at least as uncertain as as many independent trials.
+     double rate = std::clamp(estimate.miss_rate, 0.0, 1.0);
+     double bound = Z_95 * std::sqrt(rate * (1.0 - rate) / level.samples);
+
+     double mean = 0.0;
+     for (unsigned int i = 0; i < estimates; i++)
+          mean += rates[i] / estimates;
+     double variance = 0.0;
+     for (unsigned int i = 0; i < estimates; i++)
+          variance += (rates[i] - mean) * (rates[i] - mean) / (estimates - 1);
+     return std::max(bound, T_95[estimates - 2] * std::sqrt(variance / estimates));
+}
+
+double StackDistance::getMinRate() const
+{
+     std::uint64_t threshold = MODULUS;
+     for (const Level &level : levels)
+          threshold = std::min(threshold, level.threshold);
+     return static_cast<double>(threshold) / MODULUS;
+}
+
+void StackDistance::print(std::ostream &out) const
+{
+     out << "size assoc reads read_misses writes write_misses miss_rate";
+     out << (sampled ? " error" : "") << std::endl;
+     for (const Result &result : results())
+     {
+          out << result.size << ' ' << result.assoc << ' ' << result.reads << ' '
+              << result.read_misses << ' ' << result.writes << ' ' << result.write_misses
+              << ' ' << std::to_string(result.miss_rate);
+          if (sampled)
+               out << ' ' << std::to_string(result.error);
+          out << std::endl;
+     }
+}
@@ -0,0 +1,125 @@
+// Drives L1/L2/main-memory misses and fails if any of them reaches the heap. Every global
+// operator new is replaced by one that counts, and only the access loop is counted.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "cache.hpp"
+#include "inclusion_property.hpp"
+#include "instruction.hpp"
+#include "memory_access.hpp"
+#include "replacement_policy.hpp"
+
+#define BLOCKSIZE 32
+#define L1_SIZE 1024
+#define L1_ASSOC 2
+#define L2_SIZE 4096
+#define L2_ASSOC 4
+#define DIRECT_MAPPED 1
+#define NUM_ACCESSES 60000
+
+static std::atomic<std::size_t> allocations{0};
+
+void *operator new(std::size_t size)
+{
+     allocations.fetch_add(1, std::memory_order_relaxed);
+     if (void *ptr = std::malloc(size == 0 ? 1 : size))
+          return ptr;
+     throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+     allocations.fetch_add(1, std::memory_order_relaxed);
+     return std::malloc(size == 0 ? 1 : size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+     return operator new(size, tag);
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+// A mix of reads and writes over a footprint several times L2, so most accesses miss in both
+// levels, dirty victims are written back and inclusive L2 evictions invalidate L1.
+static std::vector<Instruction> make_trace()
+{
+     std::vector<Instruction> trace;
+     trace.reserve(NUM_ACCESSES);
+     unsigned int state = 12345;
+     for (unsigned int i = 0; i < NUM_ACCESSES; i++)
+     {
+          state = state * 1103515245u + 12345u;
+          unsigned int block = (state >> 8) % (4 * L2_SIZE / BLOCKSIZE);
+          unsigned short op = (state >> 4) % 3 == 0 ? 1 : 0;
+          trace.emplace_back(op, block * BLOCKSIZE + (state & (BLOCKSIZE - 1)));
+     }
+     return trace;
+}
+
+// The allocations made by running `trace` through a fresh L1/L2/memory hierarchy, and the
+// number of L1 misses among them.
+static std::size_t count_allocations(std::span<const Instruction> trace,
+                                     ReplacementPolicy policy, InclusionProperty property,
+                                     unsigned int &misses)
+{
+     Cache main_memory("MAIN_MEMORY", BLOCKSIZE, L1_SIZE + L2_SIZE, DIRECT_MAPPED, policy,
+                       property, std::span<const Instruction>(), false);
+     Cache l1("L1", BLOCKSIZE, L1_SIZE, L1_ASSOC, policy, property, trace, false);
+     Cache l2("L2", BLOCKSIZE, L2_SIZE, L2_ASSOC, policy, property, trace, false);
+     l1.next_mem_level = &l2;
+     l2.prev_mem_level = &l1;
+     l2.next_mem_level = &main_memory;
+
+     std::size_t before = allocations.load(std::memory_order_relaxed);
+     for (const auto &instruction : trace)
+     {
+          if (static_cast<MemoryAccess>(instruction.op) == MemoryAccess::Read)
+               l1.read(instruction.address);
+          else
+               l1.write(instruction.address);
+     }
+     std::size_t after = allocations.load(std::memory_order_relaxed);
+
+     misses = l1.read_misses + l1.write_misses;
+     return after - before;
+}
+
+int main()
+{
+     // Building the trace allocates, which shows the counting operator new is the one linked.
+     std::vector<Instruction> trace = make_trace();
+     if (allocations.load(std::memory_order_relaxed) == 0)
+     {
+          std::printf("operator new is not being counted\n");
+          return EXIT_FAILURE;
+     }
+     const ReplacementPolicy policies[] = {ReplacementPolicy::LRU, ReplacementPolicy::FIFO,
+                                           ReplacementPolicy::Optimal};
+     const InclusionProperty properties[] = {InclusionProperty::NonInclusive,
+                                             InclusionProperty::Inclusive};
+     const char *policy_names[] = {"LRU", "FIFO", "Optimal"};
+     const char *property_names[] = {"non-inclusive", "inclusive"};
+
+     int failures = 0;
+     for (int p = 0; p < 3; p++)
+     {
+          for (int q = 0; q < 2; q++)
+          {
+               unsigned int misses = 0;
+               std::size_t count = count_allocations(trace, policies[p], properties[q], misses);
+               std::printf("%-8s %-14s %6u L1 misses, %zu allocations\n", policy_names[p],
+                           property_names[q], misses, count);
+               if (count != 0 || misses == 0)
+                    failures++;
+          }
+     }
+     return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+// An unsampled sweep, whether by default or at rate 1.0, is exact: every row must report no
+// sampling error.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "instruction.hpp"
+#include "stack_distance.hpp"
+
+#define BLOCKSIZE 32
+#define MIN_SIZE 1024
+#define MAX_SIZE 65536
+#define NUM_ACCESSES 50000
+
+static std::vector<Instruction> make_trace()
+{
+     std::vector<Instruction> trace;
+     trace.reserve(NUM_ACCESSES);
+     unsigned int state = 2463534242u;
+     for (unsigned int i = 0; i < NUM_ACCESSES; i++)
+     {
+          state ^= state << 13;
+          state ^= state >> 17;
+          state ^= state << 5;
+          unsigned short op = state % 4 == 0 ? 1 : 0;
+          trace.emplace_back(op, state % (4 * MAX_SIZE));
+     }
+     return trace;
+}
+
+// Runs the sweep and counts the rows that report an error.
+static int inexact_rows(const std::vector<Instruction> &trace, SweepSampling sampling)
+{
+     StackDistance sweep(BLOCKSIZE, MIN_SIZE, MAX_SIZE, sampling);
+     sweep.add(trace);
+     if (sweep.isSampled())
+     {
+          std::printf("rate %g: sweep is sampled\n", sampling.rate);
+          return 1;
+     }
+
+     int failures = 0;
+     for (const auto &result : sweep.results())
+     {
+          if (result.error != 0.0)
+          {
+               std::printf("rate %g: %u B %u-way reports error %f\n", sampling.rate,
+                           result.size, result.assoc, result.error);
+               failures++;
+          }
+     }
+     return failures;
+}
+
+int main()
+{
+     std::vector<Instruction> trace = make_trace();
+
+     SweepSampling exact;
+     exact.rate = 1.0;
+     int failures = inexact_rows(trace, SweepSampling()) + inexact_rows(trace, exact);
+     return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
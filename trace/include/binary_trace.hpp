@@ -0,0 +1,111 @@
+#ifndef BINARY_TRACE_HPP
+#define BINARY_TRACE_HPP
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+#include <fstream> // for std::ofstream
+#include <span>    // for std::span
+#include <string>  // for std::string
+#include <vector>  // for std::vector
+
+#include "instruction.hpp"
+#include "mapped_file.hpp"
+
+// Payload encodings of a binary trace.
+enum class TraceEncoding : std::uint32_t
+{
+     Raw = 0,  // Array of packed Instruction records, usable in place
+     Delta = 1 // Per access: varint(zigzag(address delta) << 1 | op)
+};
+
+// Fixed 64-byte little-endian header at the start of every binary trace.
+struct BinaryTraceHeader
+{
+     static constexpr char MAGIC[8] = {'S', 'I', 'M', 'T', 'R', 'A', 'C', 'E'};
+     static constexpr std::uint32_t VERSION = 1;
+
+     char magic[8];
+     std::uint32_t version;
+     std::uint32_t encoding;
+     std::uint64_t count;         // Number of accesses
+     std::uint64_t payload_bytes; // Bytes following the header
+     std::uint64_t checksum;      // TraceChecksum of the payload
+     std::uint32_t record_bytes;  // sizeof(Instruction) when written
+     std::uint32_t reserved[5];
+};
+
+static_assert(sizeof(BinaryTraceHeader) == 64, "Binary trace header must stay 64 bytes");
+
+// FNV-1a over 64-bit little-endian words; trailing bytes are folded in as a final word.
+class TraceChecksum
+{
+public:
+     void update(const void *data, std::size_t size);
+     std::uint64_t value() const;
+
+private:
+     std::uint64_t hash = 0xcbf29ce484222325ULL;
+     std::uint64_t pending = 0;
+     unsigned int pending_bytes = 0;
+};
+
+// Streams accesses into a binary trace; the header is filled in by close().
+class BinaryTraceWriter
+{
+public:
+     BinaryTraceWriter(const std::string &path, TraceEncoding encoding);
+
+     bool is_open() const { return file.is_open(); }
+
+     void write(std::span<const Instruction> instructions);
+     bool close();
+
+     std::uint64_t getCount() const { return count; }
+     std::uint64_t getPayloadBytes() const { return payload_bytes; }
+
+private:
+     void emit(const void *data, std::size_t size);
+
+     std::ofstream file;
+     TraceEncoding encoding;
+     TraceChecksum checksum;
+     std::uint64_t count = 0;
+     std::uint64_t payload_bytes = 0;
+     unsigned int previous = 0;
+     std::vector<unsigned char> buffer;
+};
+
+// Memory-mapped binary trace. Raw payloads are exposed in place; delta payloads are decoded
+// on demand in chunks.
+class BinaryTrace
+{
+public:
+     // Returns false and sets `error` if the file is missing or malformed.
+     bool open(const std::string &path, std::string &error);
+
+     // Recomputes the payload checksum and compares it with the header.
+     bool verify() const;
+
+     // In-place view of a raw payload (empty for delta payloads).
+     std::span<const Instruction> records() const;
+
+     // Decodes up to `max` further accesses of a delta payload onto `instructions`.
+     // Returns the number decoded; zero once the payload is exhausted.
+     std::size_t decode(std::vector<Instruction> &instructions, std::size_t max);
+
+     // Getters
+     const BinaryTraceHeader &getHeader() const { return header; }
+     TraceEncoding getEncoding() const { return static_cast<TraceEncoding>(header.encoding); }
+     std::uint64_t getCount() const { return header.count; }
+     std::size_t getFileSize() const { return file.size(); }
+
+private:
+     MappedFile file;
+     BinaryTraceHeader header{};
+     const unsigned char *payload = nullptr;
+     const unsigned char *cursor = nullptr;
+     std::uint64_t decoded = 0;
+     unsigned int previous = 0;
+};
+
+#endif // BINARY_TRACE_HPP
@@ -0,0 +1,91 @@
+#ifndef BYTE_SOURCE_HPP
+#define BYTE_SOURCE_HPP
+
+#include <atomic>  // for std::atomic
+#include <cstddef> // for std::size_t
+#include <fstream> // for std::ifstream
+#include <memory>  // for std::unique_ptr
+#include <string>  // for std::string
+#include <thread>  // for std::thread
+#include <vector>  // for std::vector
+
+#include "spsc_queue.hpp"
+#include "trace_format.hpp"
+
+// Sequential source of raw (uncompressed) trace bytes.
+class ByteSource
+{
+public:
+     virtual ~ByteSource() = default;
+
+     virtual bool is_open() const = 0;
+
+     // Copies up to `size` bytes into `buffer`. Returns 0 at the end of the input.
+     virtual std::size_t read(char *buffer, std::size_t size) = 0;
+};
+
+// Opens `path`, transparently decompressing gzip and zstd inputs based on their magic bytes.
+// Returns a source that is not open if the file is missing or its format is unsupported.
+std::unique_ptr<ByteSource> open_byte_source(const std::string &path);
+
+// Plain file read in large blocks.
+class FileSource : public ByteSource
+{
+public:
+     explicit FileSource(const std::string &path) : file(path, std::ios::binary) {}
+
+     bool is_open() const override { return file.is_open(); }
+     std::size_t read(char *buffer, std::size_t size) override;
+
+private:
+     std::ifstream file;
+};
+
+// Compressed file decompressed on a background thread. Decompressed blocks reach the reader
+// through a bounded queue, so decompression overlaps parsing without any temporary file.
+class DecompressingSource : public ByteSource
+{
+public:
+     struct Block
+     {
+          std::vector<char> data;
+          std::size_t size = 0; // Bytes of `data` in use
+     };
+
+     static constexpr std::size_t BLOCK_BYTES = 1 << 20;
+     static constexpr std::size_t NUM_BLOCKS = 4;
+
+     DecompressingSource(const std::string &path, TraceFormat format);
+     ~DecompressingSource() override;
+
+     bool is_open() const override { return opened; }
+     std::size_t read(char *buffer, std::size_t size) override;
+
+private:
+     // Background thread entry point and the per-format decoders it runs. Each decoder
+     // returns false (after reporting why) if the stream is corrupt or truncated.
+     void decompress();
+     bool inflate_gzip();
+     bool decompress_zstd();
+
+     // Called by the decoders: hands out a free block to fill and publishes filled ones.
+     Block *acquire();
+     void publish(Block *block);
+
+     std::ifstream file;
+     std::string path;
+     TraceFormat format;
+     bool opened = false;
+
+     std::vector<Block> blocks;
+     SpscQueue<Block *> filled;
+     SpscQueue<Block *> empty;
+     std::thread worker;
+     std::atomic<bool> stopping{false};
+
+     // Reader-side cursor into the current block
+     Block *current = nullptr;
+     std::size_t offset = 0;
+};
+
+#endif // BYTE_SOURCE_HPP
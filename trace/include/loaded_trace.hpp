@@ -0,0 +1,40 @@
+#ifndef LOADED_TRACE_HPP
+#define LOADED_TRACE_HPP
+
+#include <span>   // for std::span
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+#include "binary_trace.hpp"
+#include "instruction.hpp"
+#include "trace_parser.hpp"
+
+// A whole trace held in memory, whatever its format. Raw binary traces stay mapped; the others
+// are parsed or decoded once into owned storage. The instructions are never modified after
+// load, so any number of simulations may read them concurrently.
+class LoadedTrace
+{
+public:
+     LoadedTrace() = default;
+     LoadedTrace(const LoadedTrace &) = delete;
+     LoadedTrace &operator=(const LoadedTrace &) = delete;
+
+     // Reports failures on std::cerr and returns false, leaving the trace empty.
+     bool load(const std::string &path, unsigned int parse_threads = 1);
+
+     // Getters
+     std::span<const Instruction> instructions() const { return trace; }
+     const TraceStats &getStats() const { return stats; }
+
+private:
+     bool loadBinary(const std::string &path);
+     bool loadCompressed(const std::string &path);
+     bool loadText(const std::string &path, unsigned int parse_threads);
+
+     std::vector<Instruction> storage; // Parsed or decoded traces
+     BinaryTrace binary;
+     std::span<const Instruction> trace; // `storage` or the mapped records
+     TraceStats stats;
+};
+
+#endif // LOADED_TRACE_HPP
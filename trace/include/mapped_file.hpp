@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef> // for std::size_t
+#include <string>  // for std::string
+
+// Read-only memory mapping of an entire file. The mapping is released on destruction.
+class MappedFile
+{
+public:
+     MappedFile() = default;
+     explicit MappedFile(const std::string &path) { open(path); }
+     ~MappedFile();
+
+     MappedFile(const MappedFile &) = delete;
+     MappedFile &operator=(const MappedFile &) = delete;
+     MappedFile(MappedFile &&other) noexcept;
+     MappedFile &operator=(MappedFile &&other) noexcept;
+
+     bool open(const std::string &path);
+     void close();
+
+     bool is_open() const { return opened; }
+
+     // Getters
+     const char *begin() const { return data; }
+     const char *end() const { return data + length; }
+     std::size_t size() const { return length; }
+
+private:
+     bool opened = false;
+     const char *data = nullptr;
+     std::size_t length = 0;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,18 @@
+#ifndef TRACE_FORMAT_HPP
+#define TRACE_FORMAT_HPP
+
+#include <string> // for std::string
+
+// On-disk trace encodings, told apart by their leading magic bytes.
+enum class TraceFormat
+{
+     Text = 0,   // "<r|w> <hex address>" per line
+     Binary = 1, // Packed records (see binary_trace.hpp)
+     Gzip = 2,   // gzip-compressed text
+     Zstd = 3    // zstd-compressed text
+};
+
+// Inspects the first bytes of `path`. Anything unrecognized is treated as text.
+TraceFormat detect_trace_format(const std::string &path);
+
+#endif // TRACE_FORMAT_HPP
@@ -0,0 +1,55 @@
+#ifndef TRACE_PARSER_HPP
+#define TRACE_PARSER_HPP
+
+#include <cstddef> // for std::size_t
+#include <iosfwd>  // for std::ostream
+#include <vector>  // for std::vector
+
+#include "instruction.hpp"
+
+// Reasons a trace line can be skipped.
+enum class TraceError
+{
+     InvalidFormat = 0,  // Fewer than two tokens on the line
+     UnknownOperation = 1, // First token is neither "r" nor "w"
+     InvalidAddress = 2  // Second token is not a hexadecimal number
+};
+
+// Counters gathered while parsing a trace. Skipped lines are tallied instead of reported
+// one at a time; only the first few are kept as examples.
+struct TraceStats
+{
+     static constexpr std::size_t MAX_EXAMPLES = 5;
+
+     struct Example
+     {
+          std::size_t line;
+          TraceError error;
+     };
+
+     void record_error(std::size_t line, TraceError error);
+     void merge(const TraceStats &other);
+
+     std::size_t errors() const { return invalid_format + unknown_operation + invalid_address; }
+     double throughput() const; // MB/s
+
+     // Prints the line/error summary and the parse throughput.
+     void report(std::ostream &os) const;
+
+     std::size_t bytes = 0;
+     std::size_t lines = 0;
+     std::size_t accesses = 0;
+     std::size_t invalid_format = 0;
+     std::size_t unknown_operation = 0;
+     std::size_t invalid_address = 0;
+     std::vector<Example> examples;
+     double seconds = 0.0;
+};
+
+// Parses every complete line of text trace in [begin, end), appending one Instruction per
+// valid "<r|w> <hex address>" line. A trailing line without a newline is only parsed when
+// `final` is set; otherwise it is left for the next call. Returns the first unparsed byte.
+const char *parse_trace_lines(const char *begin, const char *end, bool final,
+                              std::vector<Instruction> &instructions, TraceStats &stats);
+
+#endif // TRACE_PARSER_HPP
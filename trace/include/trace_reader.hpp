@@ -0,0 +1,38 @@
+#ifndef TRACE_READER_HPP
+#define TRACE_READER_HPP
+
+#include <string> // for std::string
+#include <vector> // for std::vector
+
+#include "instruction.hpp"
+#include "mapped_file.hpp"
+#include "trace_parser.hpp"
+
+// Loads a text trace by memory mapping it and scanning it in place.
+class TraceReader
+{
+public:
+     explicit TraceReader(const std::string &path);
+
+     bool is_open() const { return file.is_open(); }
+
+     // Parses the whole trace into `instructions`, reserving space up front. With more than
+     // one thread the file is split into newline-aligned chunks that are parsed concurrently
+     // and joined in order, giving exactly the same result as a sequential parse.
+     void read_all(std::vector<Instruction> &instructions, unsigned int threads = 1);
+
+     // Getters
+     const TraceStats &getStats() const { return stats; }
+     const std::string &getPath() const { return path; }
+
+private:
+     void read_sequential(std::vector<Instruction> &instructions);
+     void read_parallel(std::vector<Instruction> &instructions, unsigned int threads);
+     std::size_t estimate_accesses(std::size_t bytes) const;
+
+     std::string path;
+     MappedFile file;
+     TraceStats stats;
+};
+
+#endif // TRACE_READER_HPP
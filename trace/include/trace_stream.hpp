@@ -0,0 +1,61 @@
+#ifndef TRACE_STREAM_HPP
+#define TRACE_STREAM_HPP
+
+#include <atomic>  // for std::atomic
+#include <cstddef> // for std::size_t
+#include <memory>  // for std::unique_ptr
+#include <string>  // for std::string
+#include <thread>  // for std::thread
+#include <vector>  // for std::vector
+
+#include "byte_source.hpp"
+#include "instruction.hpp"
+#include "spsc_queue.hpp"
+#include "trace_parser.hpp"
+
+// Parses a text trace on a background thread into a fixed pool of reusable instruction
+// chunks, so memory stays bounded no matter how long the trace is. Compressed traces are
+// decompressed on a further thread (see byte_source.hpp), so both stages overlap the reader.
+class TraceStream
+{
+public:
+     using Chunk = std::vector<Instruction>;
+
+     static constexpr std::size_t DEFAULT_CHUNK_BYTES = 1 << 20;
+     static constexpr std::size_t DEFAULT_NUM_CHUNKS = 4;
+
+     explicit TraceStream(const std::string &path,
+                          std::size_t chunk_bytes = DEFAULT_CHUNK_BYTES,
+                          std::size_t num_chunks = DEFAULT_NUM_CHUNKS);
+     ~TraceStream();
+
+     TraceStream(const TraceStream &) = delete;
+     TraceStream &operator=(const TraceStream &) = delete;
+
+     bool is_open() const { return source->is_open(); }
+
+     // Starts the parser thread.
+     void start();
+
+     // Returns the next parsed chunk, or nullptr once the trace is exhausted. Every chunk
+     // must be handed back with release() before the parser can refill it.
+     Chunk *next();
+     void release(Chunk *chunk);
+
+     // Getters (complete once next() has returned nullptr)
+     const TraceStats &getStats() const { return stats; }
+
+private:
+     void produce();
+
+     std::unique_ptr<ByteSource> source;
+     std::size_t chunk_bytes;
+     std::vector<Chunk> chunks;
+     SpscQueue<Chunk *> filled;
+     SpscQueue<Chunk *> empty;
+     std::thread parser;
+     std::atomic<bool> stopping{false};
+     TraceStats stats;
+};
+
+#endif // TRACE_STREAM_HPP
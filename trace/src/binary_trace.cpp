@@ -0,0 +1,229 @@
+#include <bit>
+#include <cstring>
+
+#include "binary_trace.hpp"
+
+#define FNV_PRIME 0x100000001b3ULL
+#define WRITE_BUFFER_BYTES (1 << 16)
+#define MAX_VARINT_BYTES 5 // 33 significant bits: 32-bit zigzag delta plus the op bit
+
+static_assert(std::endian::native == std::endian::little,
+              "Binary traces are stored little-endian and mapped in place");
+
+namespace
+{
+     inline std::uint32_t zigzag(std::uint32_t delta)
+     {
+          return (delta << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(delta) >> 31);
+     }
+
+     inline std::uint32_t unzigzag(std::uint32_t value)
+     {
+          return (value >> 1) ^ (0u - (value & 1));
+     }
+}
+
+void TraceChecksum::update(const void *data, std::size_t size)
+{
+     const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+     // Finish a word left partially filled by the previous update.
+     while (pending_bytes != 0 && size > 0)
+     {
+          pending |= static_cast<std::uint64_t>(*bytes++) << (8 * pending_bytes);
+          size--;
+          if (++pending_bytes == 8)
+          {
+               hash = (hash ^ pending) * FNV_PRIME;
+               pending = 0;
+               pending_bytes = 0;
+          }
+     }
+
+     for (; size >= 8; bytes += 8, size -= 8)
+     {
+          std::uint64_t word;
+          std::memcpy(&word, bytes, 8);
+          hash = (hash ^ word) * FNV_PRIME;
+     }
+
+     for (; size > 0; size--)
+          pending |= static_cast<std::uint64_t>(*bytes++) << (8 * pending_bytes++);
+}
+
+std::uint64_t TraceChecksum::value() const
+{
+     if (pending_bytes == 0)
+          return hash;
+     return (hash ^ pending) * FNV_PRIME;
+}
+
+BinaryTraceWriter::BinaryTraceWriter(const std::string &path, TraceEncoding encoding)
+    : file(path, std::ios::binary | std::ios::trunc), encoding(encoding)
+{
+     // Reserve room for the header; close() writes the real one.
+     BinaryTraceHeader placeholder{};
+     file.write(reinterpret_cast<const char *>(&placeholder), sizeof(placeholder));
+     buffer.reserve(WRITE_BUFFER_BYTES + MAX_VARINT_BYTES);
+}
+
+void BinaryTraceWriter::write(std::span<const Instruction> instructions)
+{
+     count += instructions.size();
+
+     if (encoding == TraceEncoding::Raw)
+     {
+          emit(instructions.data(), instructions.size_bytes());
+          return;
+     }
+
+     for (const auto &instruction : instructions)
+     {
+          std::uint32_t delta = zigzag(instruction.address - previous);
+          std::uint64_t value = (static_cast<std::uint64_t>(delta) << 1) | (instruction.op & 1);
+          previous = instruction.address;
+
+          while (value >= 0x80)
+          {
+               buffer.push_back(static_cast<unsigned char>(value | 0x80));
+               value >>= 7;
+          }
+          buffer.push_back(static_cast<unsigned char>(value));
+
+          if (buffer.size() >= WRITE_BUFFER_BYTES)
+          {
+               emit(buffer.data(), buffer.size());
+               buffer.clear();
+          }
+     }
+}
+
+void BinaryTraceWriter::emit(const void *data, std::size_t size)
+{
+     checksum.update(data, size);
+     file.write(static_cast<const char *>(data), size);
+     payload_bytes += size;
+}
+
+bool BinaryTraceWriter::close()
+{
+     if (!buffer.empty())
+     {
+          emit(buffer.data(), buffer.size());
+          buffer.clear();
+     }
+
+     BinaryTraceHeader header{};
+     std::memcpy(header.magic, BinaryTraceHeader::MAGIC, sizeof(header.magic));
+     header.version = BinaryTraceHeader::VERSION;
+     header.encoding = static_cast<std::uint32_t>(encoding);
+     header.count = count;
+     header.payload_bytes = payload_bytes;
+     header.checksum = checksum.value();
+     header.record_bytes = sizeof(Instruction);
+
+     file.seekp(0);
+     file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+     file.close();
+     return !file.fail();
+}
+
+bool BinaryTrace::open(const std::string &path, std::string &error)
+{
+     if (!file.open(path))
+     {
+          error = "unable to open " + path;
+          return false;
+     }
+
+     if (file.size() < sizeof(BinaryTraceHeader))
+     {
+          error = "file too small for a binary trace header";
+          return false;
+     }
+
+     std::memcpy(&header, file.begin(), sizeof(header));
+     if (std::memcmp(header.magic, BinaryTraceHeader::MAGIC, sizeof(header.magic)) != 0)
+     {
+          error = "not a binary trace";
+          return false;
+     }
+
+     if (header.version != BinaryTraceHeader::VERSION)
+     {
+          error = "unsupported binary trace version " + std::to_string(header.version);
+          return false;
+     }
+
+     if (header.payload_bytes != file.size() - sizeof(BinaryTraceHeader))
+     {
+          error = "payload size does not match the header (truncated file?)";
+          return false;
+     }
+
+     switch (static_cast<TraceEncoding>(header.encoding))
+     {
+          case TraceEncoding::Raw:
+               if (header.record_bytes != sizeof(Instruction) ||
+                   header.payload_bytes != header.count * sizeof(Instruction))
+               {
+                    error = "raw record size does not match this build";
+                    return false;
+               }
+               break;
+
+          case TraceEncoding::Delta: break;
+
+          default:
+               error = "unknown payload encoding " + std::to_string(header.encoding);
+               return false;
+     }
+
+     payload = reinterpret_cast<const unsigned char *>(file.begin()) + sizeof(header);
+     cursor = payload;
+     decoded = 0;
+     previous = 0;
+     return true;
+}
+
+bool BinaryTrace::verify() const
+{
+     TraceChecksum checksum;
+     checksum.update(payload, header.payload_bytes);
+     return checksum.value() == header.checksum;
+}
+
+std::span<const Instruction> BinaryTrace::records() const
+{
+     if (getEncoding() != TraceEncoding::Raw)
+          return {};
+
+     // Instruction is packed (alignment 1), so the payload can be viewed in place.
+     return {reinterpret_cast<const Instruction *>(payload), header.count};
+}
+
+std::size_t BinaryTrace::decode(std::vector<Instruction> &instructions, std::size_t max)
+{
+     const unsigned char *end = payload + header.payload_bytes;
+     std::size_t produced = 0;
+
+     while (produced < max && decoded < header.count && cursor < end)
+     {
+          std::uint64_t value = 0;
+          unsigned int shift = 0;
+          while (cursor < end && shift < 7 * MAX_VARINT_BYTES)
+          {
+               unsigned char byte = *cursor++;
+               value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+               shift += 7;
+               if ((byte & 0x80) == 0) break;
+          }
+
+          previous += unzigzag(static_cast<std::uint32_t>(value >> 1));
+          instructions.emplace_back(static_cast<unsigned short>(value & 1), previous);
+          decoded++;
+          produced++;
+     }
+
+     return produced;
+}
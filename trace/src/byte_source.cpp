@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef SIM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef SIM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "byte_source.hpp"
+
+#define INPUT_BYTES (256 * 1024)
+
+std::unique_ptr<ByteSource> open_byte_source(const std::string &path)
+{
+     TraceFormat format = detect_trace_format(path);
+     if (format == TraceFormat::Gzip || format == TraceFormat::Zstd)
+          return std::make_unique<DecompressingSource>(path, format);
+
+     return std::make_unique<FileSource>(path);
+}
+
+std::size_t FileSource::read(char *buffer, std::size_t size)
+{
+     file.read(buffer, size);
+     return file.gcount();
+}
+
+DecompressingSource::DecompressingSource(const std::string &path, TraceFormat format)
+    : file(path, std::ios::binary), path(path), format(format), blocks(NUM_BLOCKS),
+      filled(NUM_BLOCKS), empty(NUM_BLOCKS)
+{
+#ifndef SIM_HAVE_ZLIB
+     if (format == TraceFormat::Gzip)
+     {
+          std::cerr << "Error: " << path << ": built without gzip support" << std::endl;
+          return;
+     }
+#endif
+#ifndef SIM_HAVE_ZSTD
+     if (format == TraceFormat::Zstd)
+     {
+          std::cerr << "Error: " << path << ": built without zstd support" << std::endl;
+          return;
+     }
+#endif
+
+     opened = file.is_open();
+     if (!opened)
+          return;
+
+     for (auto &block : blocks)
+     {
+          block.data.resize(BLOCK_BYTES);
+          empty.push(&block);
+     }
+
+     worker = std::thread(&DecompressingSource::decompress, this);
+}
+
+DecompressingSource::~DecompressingSource()
+{
+     if (!worker.joinable())
+          return;
+
+     // Stopped early: unblock the decoder and discard whatever it has already produced.
+     stopping.store(true, std::memory_order_relaxed);
+     empty.close();
+     Block *block;
+     while (filled.pop(block)) {}
+     worker.join();
+}
+
+std::size_t DecompressingSource::read(char *buffer, std::size_t size)
+{
+     std::size_t copied = 0;
+     while (copied < size)
+     {
+          // Move on to the next decompressed block once this one is used up.
+          if (current == nullptr || offset == current->size)
+          {
+               if (current != nullptr)
+                    empty.push(current);
+               current = nullptr;
+
+               if (!filled.pop(current))
+               {
+                    current = nullptr;
+                    break;
+               }
+               offset = 0;
+          }
+
+          std::size_t length = std::min(size - copied, current->size - offset);
+          std::memcpy(buffer + copied, current->data.data() + offset, length);
+          offset += length;
+          copied += length;
+     }
+     return copied;
+}
+
+DecompressingSource::Block *DecompressingSource::acquire()
+{
+     Block *block;
+     if (!empty.pop(block))
+          return nullptr;
+
+     block->size = 0;
+     return block;
+}
+
+void DecompressingSource::publish(Block *block)
+{
+     filled.push(block);
+}
+
+void DecompressingSource::decompress()
+{
+     switch (format)
+     {
+          case TraceFormat::Gzip: inflate_gzip(); break;
+          case TraceFormat::Zstd: decompress_zstd(); break;
+          default: break;
+     }
+
+     filled.close();
+}
+
+bool DecompressingSource::inflate_gzip()
+{
+#ifdef SIM_HAVE_ZLIB
+     z_stream stream{};
+     if (inflateInit2(&stream, 15 + 32) != Z_OK) // Auto-detect the gzip/zlib wrapper
+     {
+          std::cerr << "Error: " << path << ": unable to initialize zlib" << std::endl;
+          return false;
+     }
+
+     std::vector<unsigned char> input(INPUT_BYTES);
+     Block *block = acquire();
+     bool ended = false;       // The last member finished cleanly
+     bool more_output = false; // The last call filled the block and may have more to give
+     bool ok = true;
+
+     while (block != nullptr && !stopping.load(std::memory_order_relaxed))
+     {
+          if (stream.avail_in == 0 && !more_output)
+          {
+               file.read(reinterpret_cast<char *>(input.data()), input.size());
+               stream.next_in = input.data();
+               stream.avail_in = static_cast<uInt>(file.gcount());
+               if (stream.avail_in == 0)
+               {
+                    ok = ended;
+                    break;
+               }
+          }
+
+          // Concatenated gzip members decode back to back.
+          if (ended && stream.avail_in > 0)
+          {
+               inflateReset(&stream);
+               ended = false;
+          }
+
+          stream.next_out = reinterpret_cast<Bytef *>(block->data.data() + block->size);
+          stream.avail_out = static_cast<uInt>(BLOCK_BYTES - block->size);
+          int status = inflate(&stream, Z_NO_FLUSH);
+          block->size = BLOCK_BYTES - stream.avail_out;
+
+          if (status == Z_STREAM_END)
+               ended = true;
+          else if (status != Z_OK && status != Z_BUF_ERROR)
+          {
+               ok = false;
+               break;
+          }
+
+          more_output = (block->size == BLOCK_BYTES);
+          if (more_output)
+          {
+               publish(block);
+               block = acquire();
+          }
+     }
+
+     if (block != nullptr && block->size > 0)
+          publish(block);
+     inflateEnd(&stream);
+
+     if (!ok)
+          std::cerr << "Error: " << path << ": corrupt or truncated gzip stream" << std::endl;
+     return ok;
+#else
+     return false;
+#endif
+}
+
+bool DecompressingSource::decompress_zstd()
+{
+#ifdef SIM_HAVE_ZSTD
+     ZSTD_DStream *stream = ZSTD_createDStream();
+     ZSTD_initDStream(stream);
+
+     std::vector<char> input(INPUT_BYTES);
+     ZSTD_inBuffer in{input.data(), 0, 0};
+     Block *block = acquire();
+     std::size_t hint = 0;     // Zero once a frame is completely decoded
+     bool more_output = false; // The last call filled the block and may have more to give
+     bool ok = true;
+
+     while (block != nullptr && !stopping.load(std::memory_order_relaxed))
+     {
+          if (in.pos == in.size && !more_output)
+          {
+               file.read(input.data(), input.size());
+               in.size = file.gcount();
+               in.pos = 0;
+               if (in.size == 0)
+               {
+                    ok = (hint == 0);
+                    break;
+               }
+          }
+
+          ZSTD_outBuffer out{block->data.data(), BLOCK_BYTES, block->size};
+          hint = ZSTD_decompressStream(stream, &out, &in);
+          block->size = out.pos;
+          if (ZSTD_isError(hint))
+          {
+               ok = false;
+               break;
+          }
+
+          more_output = (block->size == BLOCK_BYTES);
+          if (more_output)
+          {
+               publish(block);
+               block = acquire();
+          }
+     }
+
+     if (block != nullptr && block->size > 0)
+          publish(block);
+     ZSTD_freeDStream(stream);
+
+     if (!ok)
+          std::cerr << "Error: " << path << ": corrupt or truncated zstd stream" << std::endl;
+     return ok;
+#else
+     return false;
+#endif
+}
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <iostream>
+
+#include "loaded_trace.hpp"
+#include "trace_format.hpp"
+#include "trace_reader.hpp"
+#include "trace_stream.hpp"
+
+bool LoadedTrace::load(const std::string &path, unsigned int parse_threads)
+{
+     storage.clear();
+     trace = {};
+     stats = TraceStats();
+
+     switch (detect_trace_format(path))
+     {
+          case TraceFormat::Binary: return loadBinary(path);
+          case TraceFormat::Gzip:
+          case TraceFormat::Zstd: return loadCompressed(path);
+          case TraceFormat::Text: break;
+     }
+     return loadText(path, parse_threads);
+}
+
+bool LoadedTrace::loadBinary(const std::string &path)
+{
+     std::string error;
+     if (!binary.open(path, error))
+     {
+          std::cerr << "Error: " << path << ": " << error << std::endl;
+          return false;
+     }
+
+     auto start = std::chrono::steady_clock::now();
+     if (!binary.verify())
+     {
+          std::cerr << "Error: " << path << ": checksum mismatch" << std::endl;
+          return false;
+     }
+
+     // Raw records are used in place; nothing is copied.
+     if (binary.getEncoding() == TraceEncoding::Raw)
+          trace = binary.records();
+     else
+     {
+          storage.reserve(binary.getCount());
+          binary.decode(storage, binary.getCount());
+          trace = storage;
+     }
+     std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+     stats.bytes = binary.getFileSize();
+     stats.lines = binary.getCount();
+     stats.accesses = binary.getCount();
+     stats.seconds = elapsed.count();
+     return true;
+}
+
+bool LoadedTrace::loadCompressed(const std::string &path)
+{
+     TraceStream stream(path);
+
+     if (!stream.is_open())
+     {
+          std::cerr << "Error: Unable to open trace file: " << path << std::endl;
+          return false;
+     }
+
+     // Decompression and parsing run on their own threads; collect the parsed chunks.
+     stream.start();
+     while (auto chunk = stream.next())
+     {
+          storage.insert(storage.end(), chunk->begin(), chunk->end());
+          stream.release(chunk);
+     }
+
+     trace = storage;
+     stats = stream.getStats();
+     return true;
+}
+
+bool LoadedTrace::loadText(const std::string &path, unsigned int parse_threads)
+{
+     TraceReader reader(path);
+
+     if (!reader.is_open())
+     {
+          std::cerr << "Error: Unable to open trace file: " << path << std::endl;
+          return false;
+     }
+
+     // Parse the whole trace in place; malformed lines are tallied rather than echoed.
+     reader.read_all(storage, parse_threads);
+     trace = storage;
+     stats = reader.getStats();
+     return true;
+}
@@ -0,0 +1,80 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "mapped_file.hpp"
+
+MappedFile::~MappedFile()
+{
+     close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : opened(std::exchange(other.opened, false)),
+      data(std::exchange(other.data, nullptr)),
+      length(std::exchange(other.length, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+     if (this != &other)
+     {
+          close();
+          opened = std::exchange(other.opened, false);
+          data = std::exchange(other.data, nullptr);
+          length = std::exchange(other.length, 0);
+     }
+     return *this;
+}
+
+bool MappedFile::open(const std::string &path)
+{
+     close();
+
+     int fd = ::open(path.c_str(), O_RDONLY);
+     if (fd < 0)
+          return false;
+
+     struct stat info;
+     if (fstat(fd, &info) != 0)
+     {
+          ::close(fd);
+          return false;
+     }
+
+     // An empty file is valid but cannot be mapped.
+     length = static_cast<std::size_t>(info.st_size);
+     if (length > 0)
+     {
+          void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (mapping == MAP_FAILED)
+          {
+               ::close(fd);
+               length = 0;
+               return false;
+          }
+
+          // Traces are scanned front to back, so ask the kernel to read ahead aggressively.
+          madvise(mapping, length, MADV_SEQUENTIAL);
+          data = static_cast<const char *>(mapping);
+     }
+
+     // The mapping stays valid after the descriptor is closed.
+     ::close(fd);
+     opened = true;
+     return true;
+}
+
+void MappedFile::close()
+{
+     if (data != nullptr)
+          munmap(const_cast<char *>(data), length);
+
+     opened = false;
+     data = nullptr;
+     length = 0;
+}
@@ -0,0 +1,31 @@
+#include <cstring>
+#include <fstream>
+
+#include "binary_trace.hpp"
+#include "trace_format.hpp"
+
+namespace
+{
+     const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+     const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+}
+
+TraceFormat detect_trace_format(const std::string &path)
+{
+     char magic[sizeof(BinaryTraceHeader::MAGIC)] = {};
+     std::ifstream file(path, std::ios::binary);
+     file.read(magic, sizeof(magic));
+     std::size_t length = file.gcount();
+
+     if (length >= sizeof(BinaryTraceHeader::MAGIC) &&
+         std::memcmp(magic, BinaryTraceHeader::MAGIC, sizeof(BinaryTraceHeader::MAGIC)) == 0)
+          return TraceFormat::Binary;
+
+     if (length >= sizeof(GZIP_MAGIC) && std::memcmp(magic, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == 0)
+          return TraceFormat::Gzip;
+
+     if (length >= sizeof(ZSTD_MAGIC) && std::memcmp(magic, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0)
+          return TraceFormat::Zstd;
+
+     return TraceFormat::Text;
+}
@@ -0,0 +1,200 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "memory_access.hpp"
+#include "trace_parser.hpp"
+
+#define NOT_HEX 0xFF
+#define BYTES_PER_MB (1024.0 * 1024.0)
+
+namespace
+{
+     // Lookup table from character to hexadecimal digit value (NOT_HEX otherwise).
+     constexpr std::array<std::uint8_t, 256> HEX_DIGITS = []
+     {
+          std::array<std::uint8_t, 256> table{};
+          table.fill(NOT_HEX);
+          for (int c = '0'; c <= '9'; c++) table[c] = c - '0';
+          for (int c = 'a'; c <= 'f'; c++) table[c] = c - 'a' + 10;
+          for (int c = 'A'; c <= 'F'; c++) table[c] = c - 'A' + 10;
+          return table;
+     }();
+
+     // Same whitespace set `operator>>` uses in the "C" locale, minus the newline.
+     inline bool is_space(char c)
+     {
+          return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+     }
+
+     inline bool is_hex(char c)
+     {
+          return HEX_DIGITS[static_cast<unsigned char>(c)] != NOT_HEX;
+     }
+
+     inline const char *skip_space(const char *p, const char *end)
+     {
+          while (p < end && is_space(*p)) p++;
+          return p;
+     }
+
+     inline const char *skip_token(const char *p, const char *end)
+     {
+          while (p < end && !is_space(*p)) p++;
+          return p;
+     }
+
+     // Parses a hexadecimal token the way `std::stoul(token, nullptr, 16)` does: optional sign,
+     // optional "0x" prefix, then the longest run of hex digits. Out-of-range values fail.
+     inline bool parse_hex(const char *p, const char *end, unsigned int &address)
+     {
+          bool negative = false;
+          if (p < end && (*p == '+' || *p == '-'))
+          {
+               negative = (*p == '-');
+               p++;
+          }
+
+          if (end - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x' && is_hex(p[2]))
+               p += 2;
+
+          std::uint64_t value = 0;
+          const char *digits = p;
+          for (; p < end; p++)
+          {
+               std::uint8_t digit = HEX_DIGITS[static_cast<unsigned char>(*p)];
+               if (digit == NOT_HEX) break;
+               if (value > (UINT64_MAX >> 4)) return false;
+               value = (value << 4) | digit;
+          }
+
+          if (p == digits)
+               return false;
+
+          if (negative) value = 0 - value;
+          address = static_cast<unsigned int>(value);
+          return true;
+     }
+}
+
+void TraceStats::record_error(std::size_t line, TraceError error)
+{
+     switch (error)
+     {
+          case TraceError::InvalidFormat: invalid_format++; break;
+          case TraceError::UnknownOperation: unknown_operation++; break;
+          case TraceError::InvalidAddress: invalid_address++; break;
+     }
+
+     if (examples.size() < MAX_EXAMPLES)
+          examples.push_back({line, error});
+}
+
+void TraceStats::merge(const TraceStats &other)
+{
+     // Example line numbers in `other` are relative to its own first line.
+     for (const auto &example : other.examples)
+     {
+          if (examples.size() >= MAX_EXAMPLES) break;
+          examples.push_back({lines + example.line, example.error});
+     }
+
+     bytes += other.bytes;
+     lines += other.lines;
+     accesses += other.accesses;
+     invalid_format += other.invalid_format;
+     unknown_operation += other.unknown_operation;
+     invalid_address += other.invalid_address;
+}
+
+double TraceStats::throughput() const
+{
+     if (seconds <= 0.0) return 0.0;
+     return (bytes / BYTES_PER_MB) / seconds;
+}
+
+void TraceStats::report(std::ostream &os) const
+{
+     os << "Trace: " << lines << " lines, " << accesses << " accesses";
+     if (errors() > 0)
+     {
+          os << ", " << errors() << " skipped ("
+             << invalid_format << " invalid format, "
+             << unknown_operation << " unknown instruction type, "
+             << invalid_address << " invalid address)";
+     }
+     os << std::endl;
+
+     for (const auto &example : examples)
+     {
+          std::string reason;
+          switch (example.error)
+          {
+               case TraceError::InvalidFormat: reason = "invalid format"; break;
+               case TraceError::UnknownOperation: reason = "unknown instruction type"; break;
+               case TraceError::InvalidAddress: reason = "invalid address"; break;
+          }
+          os << "  skipped line " << example.line << ": " << reason << std::endl;
+     }
+
+     os << "Parse: " << std::fixed << std::setprecision(2) << bytes / BYTES_PER_MB << " MB in "
+        << std::setprecision(3) << seconds << " s (" << std::setprecision(1) << throughput()
+        << " MB/s)" << std::endl;
+     os << std::defaultfloat;
+}
+
+const char *parse_trace_lines(const char *begin, const char *end, bool final,
+                              std::vector<Instruction> &instructions, TraceStats &stats)
+{
+     const char *cursor = begin;
+     while (cursor < end)
+     {
+          const char *eol = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+          if (eol == nullptr)
+          {
+               // Leave a partial line for the caller unless this is the end of the input.
+               if (!final) break;
+               eol = end;
+          }
+
+          std::size_t line = ++stats.lines;
+
+          // Split the line into its first two tokens.
+          const char *op_begin = skip_space(cursor, eol);
+          const char *op_end = skip_token(op_begin, eol);
+          const char *address_begin = skip_space(op_end, eol);
+          const char *address_end = skip_token(address_begin, eol);
+          cursor = (eol == end) ? end : eol + 1;
+
+          if (op_begin == op_end || address_begin == address_end)
+          {
+               stats.record_error(line, TraceError::InvalidFormat);
+               continue;
+          }
+
+          MemoryAccess access;
+          if (op_end - op_begin == 1 && *op_begin == 'r') access = MemoryAccess::Read;
+          else if (op_end - op_begin == 1 && *op_begin == 'w') access = MemoryAccess::Write;
+          else
+          {
+               stats.record_error(line, TraceError::UnknownOperation);
+               continue;
+          }
+
+          unsigned int address;
+          if (!parse_hex(address_begin, address_end, address))
+          {
+               stats.record_error(line, TraceError::InvalidAddress);
+               continue;
+          }
+
+          instructions.emplace_back(static_cast<unsigned short>(access), address);
+          stats.accesses++;
+     }
+
+     stats.bytes += cursor - begin;
+     return cursor;
+}
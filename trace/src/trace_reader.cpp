@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "trace_reader.hpp"
+
+#define SAMPLE_BYTES (64 * 1024)
+#define MIN_SAMPLE_LINES 16
+#define DEFAULT_LINE_LENGTH 11 // "r 7fffed80\n"
+#define MIN_BYTES_PER_THREAD (1 << 20)
+#define CHUNKS_PER_THREAD 4
+
+TraceReader::TraceReader(const std::string &path) : path(path), file(path)
+{
+}
+
+void TraceReader::read_all(std::vector<Instruction> &instructions, unsigned int threads)
+{
+     auto start = std::chrono::steady_clock::now();
+
+     // Small traces are not worth the thread start-up and join copy.
+     std::size_t useful = std::max<std::size_t>(1, file.size() / MIN_BYTES_PER_THREAD);
+     threads = static_cast<unsigned int>(std::min<std::size_t>(threads, useful));
+
+     if (threads <= 1)
+          read_sequential(instructions);
+     else
+          read_parallel(instructions, threads);
+
+     std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+     stats.seconds += elapsed.count();
+}
+
+void TraceReader::read_sequential(std::vector<Instruction> &instructions)
+{
+     instructions.reserve(instructions.size() + estimate_accesses(file.size()));
+     parse_trace_lines(file.begin(), file.end(), true, instructions, stats);
+}
+
+void TraceReader::read_parallel(std::vector<Instruction> &instructions, unsigned int threads)
+{
+     // Cut the mapping into more chunks than threads so uneven chunks balance out. Each cut
+     // is moved forward to just past a newline so no line straddles two chunks.
+     std::size_t numChunks = static_cast<std::size_t>(threads) * CHUNKS_PER_THREAD;
+     std::vector<const char *> bounds(numChunks + 1);
+     bounds[0] = file.begin();
+     bounds[numChunks] = file.end();
+     for (std::size_t i = 1; i < numChunks; i++)
+     {
+          const char *cut = std::max(bounds[i - 1], file.begin() + file.size() * i / numChunks);
+          const char *eol = static_cast<const char *>(std::memchr(cut, '\n', file.end() - cut));
+          bounds[i] = (eol == nullptr) ? file.end() : eol + 1;
+     }
+
+     std::vector<std::vector<Instruction>> parsed(numChunks);
+     std::vector<TraceStats> chunk_stats(numChunks);
+
+     // Parse: workers claim chunks in order from a shared counter.
+     std::atomic<std::size_t> next_chunk{0};
+     auto parse = [&]
+     {
+          for (std::size_t i = next_chunk++; i < numChunks; i = next_chunk++)
+          {
+               parsed[i].reserve(estimate_accesses(bounds[i + 1] - bounds[i]));
+               parse_trace_lines(bounds[i], bounds[i + 1], true, parsed[i], chunk_stats[i]);
+          }
+     };
+
+     std::vector<std::thread> workers;
+     for (unsigned int t = 1; t < threads; t++)
+          workers.emplace_back(parse);
+     parse();
+     for (auto &worker : workers)
+          worker.join();
+     workers.clear();
+
+     // Join: merge counters in file order and lay the chunks out back to back.
+     std::size_t base = instructions.size();
+     std::vector<std::size_t> offsets(numChunks);
+     std::size_t total = base;
+     for (std::size_t i = 0; i < numChunks; i++)
+     {
+          offsets[i] = total;
+          total += parsed[i].size();
+          stats.merge(chunk_stats[i]);
+     }
+     instructions.resize(total);
+
+     next_chunk = 0;
+     auto copy = [&]
+     {
+          for (std::size_t i = next_chunk++; i < numChunks; i = next_chunk++)
+          {
+               std::copy(parsed[i].begin(), parsed[i].end(), instructions.begin() + offsets[i]);
+               std::vector<Instruction>().swap(parsed[i]);
+          }
+     };
+
+     for (unsigned int t = 1; t < threads; t++)
+          workers.emplace_back(copy);
+     copy();
+     for (auto &worker : workers)
+          worker.join();
+}
+
+std::size_t TraceReader::estimate_accesses(std::size_t bytes) const
+{
+     if (bytes == 0)
+          return 0;
+
+     // Measure the average line length over the head of the file.
+     std::size_t sample = std::min<std::size_t>(file.size(), SAMPLE_BYTES);
+     std::size_t newlines = std::count(file.begin(), file.begin() + sample, '\n');
+
+     std::size_t line_length = DEFAULT_LINE_LENGTH;
+     if (newlines >= MIN_SAMPLE_LINES)
+          line_length = std::max<std::size_t>(1, sample / newlines);
+
+     // Leave a little headroom so the tail of the trace does not force a regrowth.
+     std::size_t estimate = bytes / line_length + 1;
+     return estimate + estimate / 32;
+}
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstring>
+
+#include "trace_stream.hpp"
+
+TraceStream::TraceStream(const std::string &path, std::size_t chunk_bytes,
+                         std::size_t num_chunks)
+    : source(open_byte_source(path)), chunk_bytes(chunk_bytes), chunks(num_chunks),
+      filled(num_chunks), empty(num_chunks)
+{
+     // Every chunk starts out free for the parser to fill.
+     for (auto &chunk : chunks)
+          empty.push(&chunk);
+}
+
+TraceStream::~TraceStream()
+{
+     if (!parser.joinable())
+          return;
+
+     // Stopped early: unblock the parser and discard whatever it has already produced.
+     stopping.store(true, std::memory_order_relaxed);
+     empty.close();
+     Chunk *chunk;
+     while (filled.pop(chunk)) {}
+     parser.join();
+}
+
+void TraceStream::start()
+{
+     parser = std::thread(&TraceStream::produce, this);
+}
+
+TraceStream::Chunk *TraceStream::next()
+{
+     Chunk *chunk;
+     if (filled.pop(chunk))
+          return chunk;
+
+     // The parser closes its queue once the whole trace has been handed over.
+     if (parser.joinable()) parser.join();
+     return nullptr;
+}
+
+void TraceStream::release(Chunk *chunk)
+{
+     empty.push(chunk);
+}
+
+void TraceStream::produce()
+{
+     std::vector<char> buffer(chunk_bytes);
+     std::size_t carry = 0;
+     Chunk *chunk = nullptr;
+
+     bool eof = false;
+     while (!eof && !stopping.load(std::memory_order_relaxed))
+     {
+          // Wait for a free chunk before touching the file so parsing stays one chunk ahead.
+          if (chunk == nullptr && !empty.pop(chunk))
+               break;
+
+          auto start = std::chrono::steady_clock::now();
+
+          // Top up the buffer behind the partial line carried over from the last block.
+          std::size_t wanted = buffer.size() - carry;
+          std::size_t got = source->read(buffer.data() + carry, wanted);
+          std::size_t length = carry + got;
+          eof = (got < wanted);
+
+          const char *begin = buffer.data();
+          const char *end = begin + length;
+          chunk->clear();
+          const char *rest = parse_trace_lines(begin, end, eof, *chunk, stats);
+          carry = end - rest;
+
+          // A single line longer than the whole buffer is already at the front: grow the
+          // buffer and read the rest of it. Otherwise move the partial line to the front.
+          if (carry == buffer.size())
+               buffer.resize(buffer.size() * 2);
+          else
+               std::memmove(buffer.data(), rest, carry);
+
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+          stats.seconds += elapsed.count();
+
+          if (!chunk->empty())
+          {
+               filled.push(chunk);
+               chunk = nullptr;
+          }
+     }
+
+     filled.close();
+}
@@ -0,0 +1,10 @@
+#ifndef HOST_CACHE_LINE_HPP
+#define HOST_CACHE_LINE_HPP
+
+#include <cstddef> // for std::size_t
+
+// Line size of the machine running the simulator, not of any simulated cache. Data that
+// different threads write, and slab records, are aligned to it.
+inline constexpr std::size_t HOST_CACHE_LINE = 64;
+
+#endif // HOST_CACHE_LINE_HPP
@@ -0,0 +1,147 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>  // for std::atomic
+#include <bit>     // for std::bit_ceil
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t
+#include <utility> // for std::move
+#include <vector>  // for std::vector
+
+#include "host_cache_line.hpp"
+
+const int SPIN_LIMIT = 256;
+
+// Bounded single-producer/single-consumer ring. The fast path is lock-free; a side that finds
+// the ring full (or empty) spins briefly and then sleeps until the other side makes progress.
+template <typename T>
+class SpscQueue
+{
+public:
+     explicit SpscQueue(std::size_t capacity)
+         : slots(std::bit_ceil(capacity < 1 ? std::size_t{1} : capacity)),
+           mask(slots.size() - 1) {}
+
+     SpscQueue(const SpscQueue &) = delete;
+     SpscQueue &operator=(const SpscQueue &) = delete;
+
+     // Producer side
+     bool try_push(T &&value)
+     {
+          std::size_t t = tail.load(std::memory_order_relaxed);
+          if (t - head_cache == slots.size())
+          {
+               head_cache = head.load(std::memory_order_acquire);
+               if (t - head_cache == slots.size()) return false;
+          }
+
+          slots[t & mask] = std::move(value);
+          tail.store(t + 1, std::memory_order_release);
+          wake(consumer_waiting, consumer_signal);
+          return true;
+     }
+
+     void push(T value)
+     {
+          while (!try_push(std::move(value)))
+               sleep(producer_waiting, producer_signal, [this] { return !full(); });
+     }
+
+     // Marks the end of the stream. The consumer drains what is left, then pop() fails.
+     void close()
+     {
+          closed.store(true, std::memory_order_release);
+          consumer_signal.fetch_add(1, std::memory_order_seq_cst);
+          consumer_signal.notify_one();
+     }
+
+     // Consumer side
+     bool try_pop(T &value)
+     {
+          std::size_t h = head.load(std::memory_order_relaxed);
+          if (h == tail_cache)
+          {
+               tail_cache = tail.load(std::memory_order_acquire);
+               if (h == tail_cache) return false;
+          }
+
+          value = std::move(slots[h & mask]);
+          head.store(h + 1, std::memory_order_release);
+          wake(producer_waiting, producer_signal);
+          return true;
+     }
+
+     // Blocks until an item is available. Returns false once the queue is closed and drained.
+     bool pop(T &value)
+     {
+          while (!try_pop(value))
+          {
+               if (closed.load(std::memory_order_acquire))
+                    return try_pop(value);
+
+               sleep(consumer_waiting, consumer_signal, [this]
+                     { return !empty() || closed.load(std::memory_order_acquire); });
+          }
+          return true;
+     }
+
+     std::size_t capacity() const { return slots.size(); }
+
+private:
+     bool full() const
+     {
+          return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire) ==
+                 slots.size();
+     }
+
+     bool empty() const
+     {
+          return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+     }
+
+     // Spin, then park on `signal` until the other side bumps it. The waiting flag is
+     // published before the final readiness check so a concurrent wake() cannot be missed.
+     template <typename Ready>
+     static void sleep(std::atomic<bool> &waiting, std::atomic<std::uint32_t> &signal,
+                       Ready ready)
+     {
+          for (int spin = 0; spin < SPIN_LIMIT; spin++)
+               if (ready()) return;
+
+          std::uint32_t seen = signal.load(std::memory_order_seq_cst);
+          waiting.store(true, std::memory_order_seq_cst);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if (!ready())
+               signal.wait(seen, std::memory_order_seq_cst);
+          waiting.store(false, std::memory_order_relaxed);
+     }
+
+     static void wake(std::atomic<bool> &waiting, std::atomic<std::uint32_t> &signal)
+     {
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if (waiting.load(std::memory_order_relaxed))
+          {
+               signal.fetch_add(1, std::memory_order_seq_cst);
+               signal.notify_one();
+          }
+     }
+
+     std::vector<T> slots;
+     std::size_t mask;
+
+     // Producer-owned line
+     alignas(HOST_CACHE_LINE) std::atomic<std::size_t> tail{0};
+     std::size_t head_cache = 0;
+
+     // Consumer-owned line
+     alignas(HOST_CACHE_LINE) std::atomic<std::size_t> head{0};
+     std::size_t tail_cache = 0;
+
+     alignas(HOST_CACHE_LINE) std::atomic<bool> closed{false};
+     std::atomic<bool> producer_waiting{false};
+     std::atomic<bool> consumer_waiting{false};
+     std::atomic<std::uint32_t> producer_signal{0};
+     std::atomic<std::uint32_t> consumer_signal{0};
+};
+
+#endif // SPSC_QUEUE_HPP
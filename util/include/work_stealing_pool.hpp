@@ -0,0 +1,105 @@
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+#include <algorithm> // for std::max
+#include <cstddef>   // for std::size_t
+#include <deque>     // for std::deque
+#include <exception> // for std::exception_ptr
+#include <mutex>     // for std::mutex
+#include <optional>  // for std::optional
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+
+#include "host_cache_line.hpp"
+
+// Runs a batch of independent tasks on a fixed number of threads. Tasks are dealt round-robin
+// into one deque per worker. A worker takes its own tasks from the front and, once they run
+// out, steals from the back of the others', so a few long tasks do not leave cores idle.
+// Deal the most expensive tasks first for the best balance.
+class WorkStealingPool
+{
+public:
+     explicit WorkStealingPool(unsigned int threads) : queues(std::max(1u, threads)) {}
+
+     WorkStealingPool(const WorkStealingPool &) = delete;
+     WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+     // Calls task(i) once for every i in [0, count) and returns when all are done. The first
+     // exception a task throws is rethrown here after the rest have finished.
+     template <typename Task>
+     void run(std::size_t count, Task &&task)
+     {
+          for (std::size_t i = 0; i < count; i++)
+               queues[i % queues.size()].tasks.push_back(i);
+
+          std::exception_ptr failure;
+          std::mutex failure_mutex;
+          auto work = [&](std::size_t self)
+          {
+               while (auto i = next(self))
+               {
+                    try
+                    {
+                         task(*i);
+                    }
+                    catch (...)
+                    {
+                         std::lock_guard<std::mutex> lock(failure_mutex);
+                         if (!failure) failure = std::current_exception();
+                    }
+               }
+          };
+
+          // The calling thread is the first worker.
+          std::vector<std::thread> workers;
+          for (std::size_t w = 1; w < queues.size(); w++)
+               workers.emplace_back(work, w);
+          work(0);
+          for (auto &worker : workers)
+               worker.join();
+
+          if (failure) std::rethrow_exception(failure);
+     }
+
+     unsigned int getNumThreads() const { return static_cast<unsigned int>(queues.size()); }
+
+private:
+     // Padded so workers polling neighbouring queues do not share a line.
+     struct alignas(HOST_CACHE_LINE) Queue
+     {
+          std::mutex mutex;
+          std::deque<std::size_t> tasks;
+     };
+
+     // Own work first, then a steal from each other worker in turn. Tasks never spawn tasks,
+     // so once every queue is empty there is nothing left to wait for.
+     std::optional<std::size_t> next(std::size_t self)
+     {
+          {
+               Queue &own = queues[self];
+               std::lock_guard<std::mutex> lock(own.mutex);
+               if (!own.tasks.empty())
+               {
+                    std::size_t i = own.tasks.front();
+                    own.tasks.pop_front();
+                    return i;
+               }
+          }
+          for (std::size_t k = 1; k < queues.size(); k++)
+          {
+               Queue &victim = queues[(self + k) % queues.size()];
+               std::lock_guard<std::mutex> lock(victim.mutex);
+               if (!victim.tasks.empty())
+               {
+                    std::size_t i = victim.tasks.back();
+                    victim.tasks.pop_back();
+                    return i;
+               }
+          }
+          return std::nullopt;
+     }
+
+     std::vector<Queue> queues;
+};
+
+#endif // WORK_STEALING_POOL_HPP